@@ -1,21 +1,58 @@
 import subprocess
 import re
+import io
 import pandas as pd
 import matplotlib.pyplot as plt
 import numpy as np
 
+# sortbench engines timed for each sort, serial first: the same pair as the first two
+# lines of the sort's own binary
+SORTBENCH_ENGINES = {
+    'sampleSort': ('quickSort', 'sampleSort'),
+    'insertionSort': ('shellSort', 'shellSortParallel'),
+}
+
+def run_sortbench(sort, n_elements_array, n_iterations):
+    # Runs the serial and parallel engines of a sort in one sortbench process and
+    # returns {n: [times in ms]} for each of them
+    sizes = ",".join(f"2^{n}" for n in n_elements_array)
+    serial, parallel = SORTBENCH_ENGINES.get(sort, (sort, f"{sort}Parallel"))
+    result = subprocess.run(["./sortbench", "--engines", f"{serial},{parallel}", "--sizes", sizes,
+                             "--reps", str(n_iterations), "--warmup", "1", "--format", "csv"],
+                            capture_output=True, text=True)
+    if result.returncode != 0:
+        raise RuntimeError(f"sortbench failed for {sort}:\n{result.stderr}")
+    df = pd.read_csv(io.StringIO(result.stdout))
+    times = {}
+    for engine in [serial, parallel]:
+        times[engine] = {n: list(df[(df.engine == engine) & (df["size"] == 2**n)].time_ns / 1e6)
+                         for n in n_elements_array}
+    return times[serial], times[parallel]
+
+def parse_times(sort, output):
+    # The binaries print "<label> time: <N> ns" per run, serial run first, and
+    # "<label> time: FAILED (...)" when the output did not verify
+    if "FAILED" in output:
+        raise RuntimeError(f"{sort} produced a wrong result:\n{output}")
+    values = re.findall(r'time: (\d+) ns', output)
+    return float(values[0]) / 1e6, float(values[1]) / 1e6 # Times in ms
+
 def main():
 
     # Since bubble and selection sort are too slow, use the smaller number of elements
     # The values are the exponents of 2 for the number of elements
 
-    # n_elements_array = [12, 14, 15, 16, 17, 18, 19, 20, 21] # Merge, Bitonic, Heap and Quick
+    # n_elements_array = [12, 14, 15, 16, 17, 18, 19, 20, 21] # Merge, Bitonic, Heap, Quick, Radix, Sample and Insertion (Shellsort)
     n_elements_array = [10, 12, 14, 15, 16] # Bubble, Selection
     
-    # sort_functions = ['quickSort', 'heapSort', 'mergeSort', 'bitonicSort']
+    # sort_functions = ['quickSort', 'heapSort', 'mergeSort', 'bitonicSort', 'radixSort', 'sampleSort', 'insertionSort']
     sort_functions = ['bubbleSort', 'selectionSort']
 
     n_iterations = 10 # Number of iterations for each number of elements for each sort
+
+    # Run every sort inside a single sortbench process (with warmups) instead of one
+    # process per iteration. Needs the sortbench binary next to this script.
+    use_sortbench = False
     serial_time = {}
     parallel_time = {}
 
@@ -23,6 +60,11 @@ def main():
         serial_time[sort] = {}
         parallel_time[sort] = {}
 
+        if use_sortbench:
+            print(f"Running {sort} with sortbench...")
+            serial_time[sort], parallel_time[sort] = run_sortbench(sort, n_elements_array, n_iterations)
+            continue
+
         for n in n_elements_array:
 
             serial_time[sort][n] = []
@@ -32,13 +74,11 @@ def main():
 
                 print(f"Iteration {i + 1} with 2**{n} elements of {sort}...")
                 output = subprocess.run([f"./{sort}", f'{2**n}'], capture_output=True, text=True).stdout
-                values = re.findall(r'\d+', output)
-                s_time = values[0]
-                p_time = values[1]
                 print(output)
+                s_time, p_time = parse_times(sort, output)
 
-                serial_time[sort][n].append(float(s_time)) # This holds a list of times for each n  
-                parallel_time[sort][n].append(float(p_time))
+                serial_time[sort][n].append(s_time) # This holds a list of times for each n  
+                parallel_time[sort][n].append(p_time)
 
     print("Serial time DataFrame")
     df_serial = pd.DataFrame(serial_time)
@@ -0,0 +1,44 @@
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include <algorithm>
+#include <omp.h>
+
+#include "adaptiveSort.h"
+#include "mergeSort.h"
+#include "benchHarness.h"
+
+/* Powersort against the non-adaptive bottom-up merge sort on the same input.
+
+Usage: adaptiveSort <array_size> [options]
+
+The interesting inputs are the presorted ones: --dist sorted, reverse, organpipe,
+sawtooth (dist-param ascending runs) and ksorted (sorted, then shuffled inside
+windows of dist-param elements), where Powersort finds the existing order and the
+bottom-up merge sort still does all of its log2(n) passes. */
+
+int main(int argc, char* argv[]) {
+    BenchArgs args;
+    if (argc < 2 || !parseBenchArgs(argc, argv, 2, args)) {
+        std::cerr << "Usage: " << argv[0] << " <array_size> " << DISTRIBUTION_USAGE << " [--phases] [--perf] " << MAPPED_FILE_USAGE << "\n";
+        return 1;
+    }
+
+    int n = std::atoi(argv[1]);
+
+    BenchData<int> data(args, n);
+    if (!data.valid()) {
+        return 1;
+    }
+    n = data.size();
+    int* arr = data.arr;
+
+    BenchReport report(args, data);
+    report.run("Power Sort", arr, [&] { powerSort(arr, n); });
+    report.run("Power Sort Parallel", arr, [&] { powerSortParallel(arr, n); });
+    report.run("Merge Sort Bottom-Up", arr, [&] { mergeSortBottomUp(arr, n); });
+    report.run("Merge Sort Bottom-Up Parallel", arr, [&] { mergeSortBottomUpParallel(arr, n); });
+    report.print();
+
+    return report.allVerified() ? 0 : 1;
+}
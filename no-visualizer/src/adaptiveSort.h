@@ -0,0 +1,418 @@
+#ifndef ADAPTIVE_SORT_H
+#define ADAPTIVE_SORT_H
+
+#include <algorithm>
+#include <vector>
+#include <omp.h>
+
+#include "mergeSort.h"
+#include "phaseTimer.h"
+#include "sortRegistry.h"
+
+/* Run-adaptive merge sort (Powersort).
+
+The other merge sorts split the input blindly and pay n log n even when it is already
+sorted. Powersort, the merge policy of CPython's list.sort since 3.11, works on the
+runs the input already has:
+- the input is scanned left to right for runs: a non-descending run is taken as it is,
+  a strictly descending one is reversed in place (strictly, so reversing keeps equal
+  keys in order). Runs shorter than ADAPTIVE_MIN_RUN are extended to that length with
+  insertion sort, so random input does not produce n runs of length 2;
+- every new run is pushed on a stack. The boundary between two neighbouring runs gets
+  a power: the depth, in a perfectly balanced merge tree over [0, n), of the node that
+  separates their midpoints. Before a new boundary of power p is recorded, the runs on
+  the stack whose boundaries are deeper than p are merged. This gives a merge tree
+  within 2 % of the optimal merge cost for the run lengths, and O(n) time on input that
+  is made of O(1) runs;
+- merges are TimSort merges. Elements of the left run that are not larger than the
+  first one of the right run, and elements of the right run not smaller than the last
+  one of the left run, are already in place and are found with a galloping (exponential
+  then binary) search. Only the shorter of the two remaining parts is copied to the
+  buffer. The merge then takes one element at a time until one side wins
+  ADAPTIVE_MIN_GALLOP times in a row, and then gallops: it finds with a search how many
+  elements in a row come from each side and moves them as blocks. The threshold
+  adapts: it drops while galloping pays off and rises again when it does not.
+The merges are stable, ties always go to the left run.
+
+The parallel version scans and sorts one contiguous chunk per thread with the serial
+algorithm. If the chunks are already in order at their boundaries (sorted or
+append-only input), that is all; otherwise they are merged in a single pass with the
+loser tree and multi-sequence selection of the multiway merge sort (mergeSort.h). */
+const int ADAPTIVE_MIN_RUN = 32;
+const int ADAPTIVE_MIN_GALLOP = 7;
+
+struct PowerRun
+{
+    int start;
+    int length;
+    int power;  // power of the boundary between this run and the next one on the stack
+};
+
+// Depth of the boundary between run [s1, s1 + n1) and the run of n2 elements after it, in [0, n)
+inline int runBoundaryPower(long long s1, long long n1, long long n2, long long n)
+{
+    // a and b are twice the midpoints of the two runs; compare the binary expansions of a / 2n and b / 2n
+    long long a = 2 * s1 + n1;
+    long long b = a + n1 + n2;
+    int power = 0;
+    while(true)
+    {
+        power++;
+        if(a >= n)
+        {
+            a -= n;
+            b -= n;
+        }
+        else if(b >= n)
+        {
+            break;
+        }
+        a <<= 1;
+        b <<= 1;
+    }
+    return power;
+}
+
+// Length of the run starting at a[0], reversed if it is strictly descending
+inline int detectRun(int a[], int n)
+{
+    if(n < 2)
+    {
+        return n;
+    }
+    int end = 2;
+    if(a[1] < a[0])
+    {
+        while(end < n && a[end] < a[end - 1])
+        {
+            end++;
+        }
+        std::reverse(a, a + end);
+    }
+    else
+    {
+        while(end < n && a[end] >= a[end - 1])
+        {
+            end++;
+        }
+    }
+    return end;
+}
+
+// Inserts a[sorted..n) into the sorted prefix a[0..sorted)
+inline void extendRun(int a[], int sorted, int n)
+{
+    PhaseTimer timer(PHASE_LEAF);
+    for(int i = sorted; i < n; i++)
+    {
+        int value = a[i];
+        int j = i - 1;
+        while(j >= 0 && a[j] > value)
+        {
+            a[j + 1] = a[j];
+            j--;
+        }
+        a[j + 1] = value;
+    }
+}
+
+// Galloping searches: the first index of base[0..length) whose element is > key (upper) or >= key (lower),
+// probing 1, 2, 4, ... elements from the front, or from the back for the FromEnd versions
+inline int gallopUpper(int key, const int base[], int length)
+{
+    int lo = 0;
+    int probe = 0;
+    for(int step = 1; probe < length && base[probe] <= key; step *= 2)
+    {
+        lo = probe + 1;
+        probe += step;
+    }
+    return (int)(std::upper_bound(base + lo, base + std::min(probe, length), key) - base);
+}
+
+inline int gallopLower(int key, const int base[], int length)
+{
+    int lo = 0;
+    int probe = 0;
+    for(int step = 1; probe < length && base[probe] < key; step *= 2)
+    {
+        lo = probe + 1;
+        probe += step;
+    }
+    return (int)(std::lower_bound(base + lo, base + std::min(probe, length), key) - base);
+}
+
+inline int gallopUpperFromEnd(int key, const int base[], int length)
+{
+    int hi = length;
+    int probe = length - 1;
+    for(int step = 1; probe >= 0 && base[probe] > key; step *= 2)
+    {
+        hi = probe;
+        probe -= step;
+    }
+    return (int)(std::upper_bound(base + std::max(probe + 1, 0), base + hi, key) - base);
+}
+
+inline int gallopLowerFromEnd(int key, const int base[], int length)
+{
+    int hi = length;
+    int probe = length - 1;
+    for(int step = 1; probe >= 0 && base[probe] >= key; step *= 2)
+    {
+        hi = probe;
+        probe -= step;
+    }
+    return (int)(std::lower_bound(base + std::max(probe + 1, 0), base + hi, key) - base);
+}
+
+// Merge of a[0..na) and a[na..na + nb) with the left run copied to the buffer, front to back
+inline void mergeLow(int a[], int na, int nb, int buffer[], int& minGallop)
+{
+    std::copy(a, a + na, buffer);
+    const int* left = buffer;
+    int* right = a + na;
+    int* dest = a;
+    int pa = 0;
+    int pb = 0;
+    while(pa < na && pb < nb)
+    {
+        int winsLeft = 0;
+        int winsRight = 0;
+        while(pa < na && pb < nb && winsLeft < minGallop && winsRight < minGallop)
+        {
+            if(right[pb] < left[pa])
+            {
+                *dest++ = right[pb++];
+                winsRight++;
+                winsLeft = 0;
+            }
+            else
+            {
+                *dest++ = left[pa++];
+                winsLeft++;
+                winsRight = 0;
+            }
+        }
+        while(pa < na && pb < nb)
+        {
+            // dest stays behind right + pb, so the forward copies never overwrite what they read
+            int fromLeft = gallopUpper(right[pb], left + pa, na - pa);
+            dest = std::copy(left + pa, left + pa + fromLeft, dest);
+            pa += fromLeft;
+            if(pa == na)
+            {
+                break;
+            }
+            int fromRight = gallopLower(left[pa], right + pb, nb - pb);
+            dest = std::copy(right + pb, right + pb + fromRight, dest);
+            pb += fromRight;
+            if(fromLeft < ADAPTIVE_MIN_GALLOP && fromRight < ADAPTIVE_MIN_GALLOP)
+            {
+                minGallop++;
+                break;
+            }
+            minGallop = std::max(1, minGallop - 1);
+        }
+    }
+    // What is left of the right run is already in place
+    std::copy(left + pa, left + na, dest);
+}
+
+// Merge of a[0..na) and a[na..na + nb) with the right run copied to the buffer, back to front
+inline void mergeHigh(int a[], int na, int nb, int buffer[], int& minGallop)
+{
+    std::copy(a + na, a + na + nb, buffer);
+    const int* right = buffer;
+    int* left = a;
+    int pa = na - 1;
+    int pb = nb - 1;
+    int* dest = a + na + nb - 1;
+    while(pa >= 0 && pb >= 0)
+    {
+        int winsLeft = 0;
+        int winsRight = 0;
+        while(pa >= 0 && pb >= 0 && winsLeft < minGallop && winsRight < minGallop)
+        {
+            if(left[pa] > right[pb])
+            {
+                *dest-- = left[pa--];
+                winsLeft++;
+                winsRight = 0;
+            }
+            else
+            {
+                *dest-- = right[pb--];
+                winsRight++;
+                winsLeft = 0;
+            }
+        }
+        while(pa >= 0 && pb >= 0)
+        {
+            int first = gallopUpperFromEnd(right[pb], left, pa + 1);
+            int fromLeft = pa + 1 - first;
+            std::copy_backward(left + first, left + pa + 1, dest + 1);
+            dest -= fromLeft;
+            pa = first - 1;
+            if(pa < 0)
+            {
+                break;
+            }
+            first = gallopLowerFromEnd(left[pa], right, pb + 1);
+            int fromRight = pb + 1 - first;
+            std::copy_backward(right + first, right + pb + 1, dest + 1);
+            dest -= fromRight;
+            pb = first - 1;
+            if(fromLeft < ADAPTIVE_MIN_GALLOP && fromRight < ADAPTIVE_MIN_GALLOP)
+            {
+                minGallop++;
+                break;
+            }
+            minGallop = std::max(1, minGallop - 1);
+        }
+    }
+    // What is left of the left run is already in place
+    std::copy_backward(right, right + pb + 1, dest + 1);
+}
+
+// Stable merge of the adjacent sorted runs a[0..na) and a[na..na + nb)
+inline void mergeAdjacentRuns(int a[], int na, int nb, int buffer[], int& minGallop)
+{
+    PhaseTimer timer(PHASE_MERGE);
+    // The left elements <= the first right one, and the right elements >= the last left one, stay
+    int skip = gallopUpper(a[na], a, na);
+    a += skip;
+    na -= skip;
+    if(na == 0)
+    {
+        return;
+    }
+    nb = gallopLowerFromEnd(a[na - 1], a + na, nb);
+    if(nb == 0)
+    {
+        return;
+    }
+    if(na <= nb)
+    {
+        mergeLow(a, na, nb, buffer, minGallop);
+    }
+    else
+    {
+        mergeHigh(a, na, nb, buffer, minGallop);
+    }
+}
+
+// Sorts a[0..n) with buffer (at least n / 2 elements) for the merges
+inline void powerSortRange(int a[], int n, int buffer[])
+{
+    std::vector<PowerRun> stack;
+    int minGallop = ADAPTIVE_MIN_GALLOP;
+    auto mergeTop = [&] {
+        PowerRun& left = stack[stack.size() - 2];
+        const PowerRun& right = stack.back();
+        mergeAdjacentRuns(a + left.start, left.length, right.length, buffer, minGallop);
+        left.length += right.length;
+        stack.pop_back();
+    };
+
+    for(int start = 0; start < n; )
+    {
+        int length = detectRun(a + start, n - start);
+        if(length < ADAPTIVE_MIN_RUN)
+        {
+            int extended = std::min(ADAPTIVE_MIN_RUN, n - start);
+            extendRun(a + start, length, extended);
+            length = extended;
+        }
+        if(!stack.empty())
+        {
+            int power = runBoundaryPower(stack.back().start, stack.back().length, length, n);
+            while(stack.size() > 1 && stack[stack.size() - 2].power > power)
+            {
+                mergeTop();
+            }
+            stack.back().power = power;
+        }
+        stack.push_back(PowerRun{start, length, 0});
+        start += length;
+    }
+    while(stack.size() > 1)
+    {
+        mergeTop();
+    }
+}
+
+inline void powerSort(int a[], int n)
+{
+    if(n < 2)
+    {
+        return;
+    }
+    int* buffer = new int[n / 2 + 1];
+    powerSortRange(a, n, buffer);
+    delete[] buffer;
+}
+
+inline void powerSortParallel(int a[], int n)
+{
+    int maxThreads = omp_get_max_threads();
+    if(n < 2 * ADAPTIVE_MIN_RUN * maxThreads)
+    {
+        powerSort(a, n);
+        return;
+    }
+    int* buffer = new int[n];
+    std::vector<int> bounds(maxThreads + 1);
+    bool ordered = true;
+
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int p = omp_get_num_threads();
+        int begin = (int)((long long)n * tid / p);
+        int end = (int)((long long)n * (tid + 1) / p);
+        bounds[tid] = begin;
+        if(tid == p - 1)
+        {
+            bounds[p] = n;
+        }
+
+        // Parallel run scan: every thread finds and merges the runs of its chunk
+        powerSortRange(a + begin, end - begin, buffer + begin);
+        #pragma omp barrier
+
+        #pragma omp single
+        for(int t = 1; t < p; t++)
+        {
+            ordered = ordered && a[bounds[t] - 1] <= a[bounds[t]];
+        }
+
+        if(!ordered)
+        {
+            std::copy(a + begin, a + end, buffer + begin);
+            #pragma omp barrier
+
+            std::vector<int> from(p);
+            std::vector<int> to(p);
+            multiwaySelect(buffer, bounds.data(), p, begin, from.data());
+            multiwaySelect(buffer, bounds.data(), p, end, to.data());
+
+            PhaseTimer timer(PHASE_MERGE);
+            std::vector<const int*> runBegin(p);
+            std::vector<const int*> runEnd(p);
+            for(int j = 0; j < p; j++)
+            {
+                runBegin[j] = buffer + from[j];
+                runEnd[j] = buffer + to[j];
+            }
+            LoserTree tree(runBegin.data(), runEnd.data(), p);
+            tree.merge(a + begin, end - begin);
+        }
+    }
+    delete[] buffer;
+}
+
+REGISTER_SORT(powerSort, "adaptiveSort", false, powerSort)
+REGISTER_SORT(powerSortParallel, "adaptiveSort", true, powerSortParallel)
+
+#endif
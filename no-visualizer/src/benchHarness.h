@@ -0,0 +1,394 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+#include <climits>
+#include <string>
+#include <vector>
+
+#include "distributions.h"
+#include "mappedFile.h"
+#include "phaseTimer.h"
+#include "perfCounters.h"
+
+/* Timing and verification shared by the benchmark binaries.
+
+Every timed run starts from the same input, is timed in nanoseconds (milliseconds
+rounded most runs below 2^15 elements down to 0 or 1) and is verified afterwards: the
+output must be in ascending order and must have the same permutation checksum as the
+input, so a kernel that drops, duplicates or invents elements cannot post a time.
+A failed run prints FAILED instead of its time and makes the binary exit with 1.
+
+With --phases the runs also report the partition / merge / leaf-sort breakdown
+collected by the PhaseTimers in the engines, and with --perf the hardware counters of
+perfCounters.h, read around the timed region only. With --input the keys come from a
+file mapped with mmap (mappedFile.h) and every run also reports its page-in time. */
+struct BenchArgs
+{
+    DistributionOptions input;
+    MappedFileOptions file;
+    bool phases = false;
+    bool perf = false;
+};
+
+// Parses the benchmark options in argv[first..argc)
+inline bool parseBenchArgs(int argc, char* argv[], int first, BenchArgs& args)
+{
+    for(int i = first; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if(arg == "--phases")
+        {
+            args.phases = true;
+            continue;
+        }
+        if(arg == "--perf")
+        {
+            args.perf = true;
+            continue;
+        }
+        if(i + 1 >= argc)
+        {
+            std::cerr << "Missing value for " << arg << "\n";
+            return false;
+        }
+        std::string value = argv[++i];
+        bool valid = true;
+        if(!parseDistributionOption(arg, value, args.input, valid) &&
+           !parseMappedFileOption(arg, value, args.file, valid))
+        {
+            std::cerr << "Unknown option " << arg << "\n";
+            return false;
+        }
+        if(!valid)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// splitmix64 finalizer
+inline unsigned long long checksumMix(unsigned long long x)
+{
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Order-independent checksum: the sum of a 64-bit mix of the bits of every element.
+// Elements wider than 64 bits (the records of recordSort.h) are mixed one word at a time.
+template<typename T>
+inline unsigned long long permutationChecksum(const T* a, int n)
+{
+    unsigned long long sum = 0;
+    for(int i = 0; i < n; i++)
+    {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&a[i]);
+        unsigned long long h = 0;
+        for(size_t offset = 0; offset < sizeof(T); offset += sizeof(h))
+        {
+            unsigned long long x = 0;
+            std::memcpy(&x, bytes + offset, std::min(sizeof(T) - offset, sizeof(x)));
+            h = checksumMix(h ^ x);
+        }
+        sum += h;
+    }
+    return sum;
+}
+
+template<typename T>
+inline bool isSorted(const T* a, int n)
+{
+    for(int i = 1; i < n; i++)
+    {
+        if(a[i] < a[i - 1])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* The input of a benchmark binary and the array its runs sort: generated into heap
+memory, or mapped from the --input file. With --input, n is the number of keys to
+sort from the start of the file, 0 for all of them. */
+template<typename T>
+class BenchData
+{
+public:
+    BenchData(const BenchArgs& args, int n)
+    {
+        if(args.file.input.empty())
+        {
+            count = n;
+            generated = new T[n];
+            arr = new T[n];
+            fillDistribution(generated, n, args.input);
+            return;
+        }
+        if(!mapped.open(args.file, n))
+        {
+            std::cerr << mapped.error() << "\n";
+            return;
+        }
+        if(mapped.size() > INT_MAX)
+        {
+            std::cerr << args.file.input << " holds more keys than the engines can index, pass a smaller array size\n";
+            return;
+        }
+        count = (int)mapped.size();
+        fromFile = true;
+        arr = mapped.data();
+    }
+
+    BenchData(const BenchData&) = delete;
+    BenchData& operator=(const BenchData&) = delete;
+
+    ~BenchData()
+    {
+        delete[] generated;
+        if(!fromFile)
+        {
+            delete[] arr;
+        }
+    }
+
+    bool valid() const
+    {
+        return count >= 0;
+    }
+
+    bool fileBacked() const
+    {
+        return fromFile;
+    }
+
+    int size() const
+    {
+        return count;
+    }
+
+    const T* input() const
+    {
+        return fromFile ? mapped.input() : generated;
+    }
+
+    // Restores the input in arr before a run; returns the page-in time of a mapped file
+    long long reset()
+    {
+        if(fromFile)
+        {
+            return mapped.reset();
+        }
+        std::copy(generated, generated + count, arr);
+        return 0;
+    }
+
+    T* arr = nullptr;
+
+private:
+    int count = -1;
+    bool fromFile = false;
+    T* generated = nullptr;
+    MappedKeys<T> mapped;
+};
+
+struct BenchRun
+{
+    std::string label;
+    long long timeNs;
+    long long pageInNs;
+    FaultCount sortFaults;
+    bool sorted;
+    bool permutation;
+    long long phaseNs[PHASE_COUNT];
+    PerfSample counters;
+};
+
+// T is deduced from the constructor, so the benchmark mains just write BenchReport report(args, data)
+// with their BenchData; recordSort, which has no BenchData, passes its input as (args, input, n)
+template<typename T>
+class BenchReport
+{
+public:
+    BenchReport(const BenchArgs& args, const T* input, int n)
+        : args(args), input(input), n(n), inputChecksum(permutationChecksum(input, n))
+    {
+        if(args.perf && !counters.open())
+        {
+            std::cerr << counters.error() << ", reporting timings only\n";
+        }
+    }
+
+    // Runs on the buffers of data, which also restores the input before each run
+    BenchReport(const BenchArgs& args, BenchData<T>& data) : BenchReport(args, data.input(), data.size())
+    {
+        this->data = &data;
+    }
+
+    // Copies the input into arr, times sort() and verifies arr afterwards
+    template<typename Sort>
+    void run(const std::string& label, T* arr, Sort sort)
+    {
+        run(label, arr, [] {}, sort, [] {});
+    }
+
+    // For engines that sort another layout of the data: prepare() converts arr to it and
+    // finish() writes the result back to arr, both outside the timed region
+    template<typename Prepare, typename Sort, typename Finish>
+    void run(const std::string& label, T* arr, Prepare prepare, Sort sort, Finish finish)
+    {
+        long long pageInNs = 0;
+        if(data != nullptr)
+        {
+            pageInNs = data->reset();
+        }
+        else
+        {
+            std::copy(input, input + n, arr);
+        }
+        prepare();
+        resetPhaseTimers();
+        phaseTimingEnabled = args.phases;
+        FaultCount faultsBefore = processFaults();
+        counters.start();
+
+        auto start = std::chrono::steady_clock::now();
+        sort();
+        auto end = std::chrono::steady_clock::now();
+
+        counters.stop();
+        FaultCount faultsAfter = processFaults();
+        phaseTimingEnabled = false;
+        finish();
+
+        BenchRun result;
+        result.label = label;
+        result.timeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        result.pageInNs = pageInNs;
+        result.sortFaults.minor = faultsAfter.minor - faultsBefore.minor;
+        result.sortFaults.major = faultsAfter.major - faultsBefore.major;
+        result.sorted = isSorted(arr, n);
+        result.permutation = permutationChecksum(arr, n) == inputChecksum;
+        for(int p = 0; p < PHASE_COUNT; p++)
+        {
+            result.phaseNs[p] = phaseTotalNs(static_cast<SortPhase>(p));
+        }
+        result.counters = counters.read();
+        runs.push_back(result);
+    }
+
+    // The time lines come first, in run order, so runner.py can read them positionally
+    void print() const
+    {
+        for(const BenchRun& result : runs)
+        {
+            if(verified(result))
+            {
+                std::cout << result.label << " time: " << result.timeNs << " ns\n";
+            }
+            else
+            {
+                std::cout << result.label << " time: FAILED ("
+                          << (result.sorted ? "" : "not sorted")
+                          << (!result.sorted && !result.permutation ? ", " : "")
+                          << (result.permutation ? "" : "not a permutation of the input") << ")\n";
+            }
+        }
+        if(data != nullptr && data->fileBacked())
+        {
+            printPageIns();
+        }
+        if(args.phases)
+        {
+            printPhases();
+        }
+        if(counters.available())
+        {
+            printCounters();
+        }
+    }
+
+    bool allVerified() const
+    {
+        for(const BenchRun& result : runs)
+        {
+            if(!verified(result))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    static bool verified(const BenchRun& result)
+    {
+        return result.sorted && result.permutation;
+    }
+
+    void printPageIns() const
+    {
+        for(const BenchRun& result : runs)
+        {
+            std::cout << result.label << " page-in: " << result.pageInNs << " ns (faults during the sort: "
+                      << result.sortFaults.minor << " minor, " << result.sortFaults.major << " major)\n";
+        }
+    }
+
+    void printPhases() const
+    {
+        for(const BenchRun& result : runs)
+        {
+            long long inPhases = 0;
+            std::cout << result.label << " phases (thread time):";
+            for(int p = 0; p < PHASE_COUNT; p++)
+            {
+                std::cout << " " << PHASE_NAMES[p] << " " << result.phaseNs[p] << " ns,";
+                inPhases += result.phaseNs[p];
+            }
+            std::cout << " recursion and other " << std::max(0LL, result.timeNs - inPhases) << " ns\n";
+        }
+    }
+
+    // Counters summed over the team, with instructions per cycle next to the instruction count
+    void printCounters() const
+    {
+        for(const BenchRun& result : runs)
+        {
+            const PerfSample& sample = result.counters;
+            std::cout << result.label << " counters:";
+            for(int c = 0; c < PERF_COUNTER_COUNT; c++)
+            {
+                std::cout << (c > 0 ? ", " : " ") << PERF_COUNTER_NAMES[c] << " ";
+                if(!sample.valid[c])
+                {
+                    std::cout << "n/a";
+                    continue;
+                }
+                std::cout << sample.value[c];
+                if(c == PERF_INSTRUCTIONS && sample.valid[PERF_CYCLES] && sample.value[PERF_CYCLES] > 0)
+                {
+                    std::cout << " (IPC " << std::fixed << std::setprecision(2)
+                              << (double)sample.value[c] / sample.value[PERF_CYCLES] << ")";
+                }
+            }
+            std::cout << "\n";
+        }
+    }
+
+    BenchArgs args;
+    BenchData<T>* data = nullptr;
+    const T* input;
+    int n;
+    unsigned long long inputChecksum;
+    std::vector<BenchRun> runs;
+    PerfCounters counters;
+};
+
+#endif
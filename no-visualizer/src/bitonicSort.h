@@ -0,0 +1,274 @@
+#ifndef BITONIC_SORT_H
+#define BITONIC_SORT_H
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <omp.h>
+
+#include "phaseTimer.h"
+#include "simdSort.h"
+#include "sortRegistry.h"
+#include "tuning.h"
+#include "workStealing.h"
+
+inline void bitonicMerge(int arr[], int low, int count, bool dir)
+{
+    if (count > 1)
+    {
+        int k = count / 2;
+        for (int i = low; i < low + k; i++)
+        {
+            if ((dir && arr[i] > arr[i + k]) || (!dir && arr[i] < arr[i + k]))
+            {
+                int temp = arr[i];
+                arr[i] = arr[i + k];
+                arr[i + k] = temp;
+            }
+        }
+        bitonicMerge(arr, low, k, dir);
+        bitonicMerge(arr, low + k, k, dir);
+    }
+}
+
+// Sorts a small block with the in-register network, in the direction the bitonic network expects
+inline void bitonicSortLeaf(int a[], int low, int count, bool dir)
+{
+    simdSortSmall(a + low, count);
+    if (!dir)
+    {
+        std::reverse(a + low, a + low + count);
+    }
+}
+
+inline void bitonicSortRec(int a[], int low, int count, bool dir)
+{
+    if (count > 1 && count <= SIMD_SORT_MAX)
+    {
+        bitonicSortLeaf(a, low, count, dir);
+    }
+    else if (count > 1)
+    {
+        int k = count / 2;
+
+        bitonicSortRec(a, low, k, true);
+        bitonicSortRec(a, low + k, k, false);
+
+        PhaseTimer timer(PHASE_MERGE);
+        bitonicMerge(a, low, count, dir);
+    }
+}
+
+inline void bitonicSort(int a[], int count, bool dir)
+{
+    bitonicSortRec(a, 0, count, dir);
+}
+
+inline void bitonicMergeParallel(int a[], int low, int count, bool dir)
+{
+    if(count > 1)
+    {
+        int k = count / 2;
+        for(int i = low; i < low + k; i++)
+        {
+            if((dir && a[i] > a[i + k]) || (!dir && a[i] < a[i + k]))
+            {
+                int temp = a[i];
+                a[i] = a[i + k];
+                a[i + k] = temp;
+            }
+        }
+        bitonicMergeParallel(a, low, k, dir);
+        bitonicMergeParallel(a, low + k, k, dir);
+    }
+}
+
+// Halves up to this size are sorted by the task that reaches them (see tuning.h)
+inline int bitonicSortTaskCutoff = 5000;
+REGISTER_TUNABLE(bitonicSortTaskCutoff, "bitonicSortParallel", 256, 262144)
+
+inline void bitonicSortParallelHelper(int a[], int low, int count, bool dir)
+{
+    if(count > 1 && count <= SIMD_SORT_MAX)
+    {
+        bitonicSortLeaf(a, low, count, dir);
+    }
+    else if(count > 1)
+    {
+        int k = count / 2;
+        //using a threshold to limit the creation of small tasks
+        if(count > bitonicSortTaskCutoff){
+            forkJoin([&] { bitonicSortParallelHelper(a, low, k, true); },
+                     [&] { bitonicSortParallelHelper(a, low + k, k, false); });
+        }else{
+
+            bitonicSortParallelHelper(a, low, k, true);
+            bitonicSortParallelHelper(a, low + k, k, false);
+        }
+        PhaseTimer timer(PHASE_MERGE);
+        bitonicMergeParallel(a, low, count, dir);
+    }
+}
+
+inline void bitonicSortParallel(int a[], int size, TaskBackend backend = TaskBackend::OpenMP)
+{
+    runTaskRoot(backend, [&] { bitonicSortParallelHelper(a, 0, size, true); });
+}
+
+/* Iterative bitonic sort.
+
+The recursive versions above only parallelize the recursive split: every merge runs
+as a serial loop, and they assume count is a power of two. Here the network is
+written as its sequence of compare-exchange stages. Stage (k, j) compares every
+element i with its partner i ^ j, in ascending order when bit k of i is clear and in
+descending order otherwise. All n/2 compare-exchanges of a stage are independent, so
+the parallel version gives every thread an equal, fixed share of the pairs and keeps
+a single team alive for all O(log^2 n) stages, with one barrier between stages.
+
+Sizes that are not a power of two are padded up to the next power of two with
+INT_MAX, which sorts to the end, and only the first n elements are copied back. */
+inline void bitonicStage(int a[], int pBegin, int pEnd, int j, int k)
+{
+    PhaseTimer timer(PHASE_MERGE);
+    for(int p = pBegin; p < pEnd; p++)
+    {
+        // p-th pair of the stage: i has bit j clear, its partner is i + j
+        int i = ((p & ~(j - 1)) << 1) | (p & (j - 1));
+        int l = i + j;
+        int lo = std::min(a[i], a[l]);
+        int hi = std::max(a[i], a[l]);
+        bool ascending = (i & k) == 0;
+        a[i] = ascending ? lo : hi;
+        a[l] = ascending ? hi : lo;
+    }
+}
+
+// The padded buffer is indexed with int, so it holds at most 2^30 elements
+const int BITONIC_MAX_SIZE = 1 << 30;
+
+// Smallest power of two >= n, or -1 if that is larger than BITONIC_MAX_SIZE
+inline int nextPowerOfTwo(int n)
+{
+    long long size = 1;
+    while(size < n)
+    {
+        size <<= 1;
+    }
+    return size <= BITONIC_MAX_SIZE ? (int)size : -1;
+}
+
+inline bool bitonicSizeSupported(int n)
+{
+    if(nextPowerOfTwo(n) < 0)
+    {
+        std::cerr << "Bitonic sort pads to a power of two and supports at most " << BITONIC_MAX_SIZE << " elements, not "
+                  << n << "\n";
+        return false;
+    }
+    return true;
+}
+
+inline int* bitonicPaddedBuffer(int a[], int n, int size)
+{
+    if(size == n)
+    {
+        return a;
+    }
+    int* padded = new int[size];
+    std::copy(a, a + n, padded);
+    std::fill(padded + n, padded + size, std::numeric_limits<int>::max());
+    return padded;
+}
+
+inline void bitonicUnpad(int a[], int n, int* padded)
+{
+    if(padded != a)
+    {
+        std::copy(padded, padded + n, a);
+        delete[] padded;
+    }
+}
+
+inline void bitonicSortIterative(int a[], int n)
+{
+    if(n < 2 || !bitonicSizeSupported(n))
+    {
+        return;
+    }
+    int size = nextPowerOfTwo(n);
+    int* data = bitonicPaddedBuffer(a, n, size);
+
+    for(long long k = 2; k <= size; k <<= 1)
+    {
+        for(int j = (int)(k >> 1); j > 0; j >>= 1)
+        {
+            bitonicStage(data, 0, size / 2, j, (int)k);
+        }
+    }
+
+    bitonicUnpad(a, n, data);
+}
+
+inline void bitonicSortIterativeParallel(int a[], int n)
+{
+    if(n < 2 || !bitonicSizeSupported(n))
+    {
+        return;
+    }
+    int size = nextPowerOfTwo(n);
+    int* data = bitonicPaddedBuffer(a, n, size);
+    int pairs = size / 2;
+
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        int pBegin = (int)((long long)pairs * tid / nthreads);
+        int pEnd = (int)((long long)pairs * (tid + 1) / nthreads);
+
+        for(long long k = 2; k <= size; k <<= 1)
+        {
+            for(int j = (int)(k >> 1); j > 0; j >>= 1)
+            {
+                bitonicStage(data, pBegin, pEnd, j, (int)k);
+                #pragma omp barrier
+            }
+        }
+    }
+
+    bitonicUnpad(a, n, data);
+}
+
+// The recursive networks need a power-of-two count; these pad any n with INT_MAX
+inline void bitonicSortPadded(int a[], int n)
+{
+    if(!bitonicSizeSupported(n))
+    {
+        return;
+    }
+    int size = nextPowerOfTwo(n);
+    int* data = bitonicPaddedBuffer(a, n, size);
+    bitonicSort(data, size, true);
+    bitonicUnpad(a, n, data);
+}
+
+inline void bitonicSortParallelPadded(int a[], int n, TaskBackend backend = TaskBackend::OpenMP)
+{
+    if(!bitonicSizeSupported(n))
+    {
+        return;
+    }
+    int size = nextPowerOfTwo(n);
+    int* data = bitonicPaddedBuffer(a, n, size);
+    bitonicSortParallel(data, size, backend);
+    bitonicUnpad(a, n, data);
+}
+
+REGISTER_SORT(bitonicSort, "bitonicSort", false, bitonicSortPadded)
+REGISTER_SORT(bitonicSortParallel, "bitonicSort", true, [](int* a, int n) { bitonicSortParallelPadded(a, n); })
+REGISTER_SORT(bitonicSortParallelStealing, "bitonicSort", true,
+              [](int* a, int n) { bitonicSortParallelPadded(a, n, TaskBackend::WorkStealing); })
+REGISTER_SORT(bitonicSortIterative, "bitonicSort", false, bitonicSortIterative)
+REGISTER_SORT(bitonicSortIterativeParallel, "bitonicSort", true, bitonicSortIterativeParallel)
+
+#endif
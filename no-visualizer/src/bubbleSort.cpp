@@ -3,98 +3,34 @@
 #include <ctime>
 #include <chrono>
 #include <random>
+#include <algorithm>
+#include <limits>
 #include <omp.h>
 
-
-void bubbleSort(int* arr, int arrSize)
-{
-    for(int i=0; i<arrSize; i++)
-    {
-        for(int j=0; j<arrSize-i; j++)
-        {
-            if(arr[j+1]<arr[j])
-            {
-                int temp=arr[j];
-                arr[j]=arr[j+1];
-                arr[j+1]=temp;
-            }
-        }
-    }
-}
-
-
-void bubbleSortParallel(int* arr, int arrSize)
-/*
-In general bubbleSort is sequential as comparisons move along
-the array. To parallelize this doesn't work.
-
-A possible solution is to first compare even-starting pairs
-and odd-starting pairs. In this manner in the same iteration
-one shift doesn't need to be sequential with the others, then
-you may use openMP for parallel computing.
-
-*/
-{
-    for (int i = 0; i < arrSize; i++)
-    {
-        int phase = i % 2;
-
-        #pragma omp parallel for
-        for (int j = phase; j < arrSize - 1; j += 2)
-        {
-            if (arr[j] > arr[j + 1])
-            {
-                // Swap
-                int temp = arr[j];
-                arr[j] = arr[j + 1];
-                arr[j + 1] = temp;
-            }
-        }
-    }
-}
-
-void fillRandom(int* arr, int size, std::mt19937& gen, std::uniform_int_distribution<>& dist) {
-    for (int i = 0; i < size; ++i) {
-        arr[i] = dist(gen);
-    }
-}
+#include "bubbleSort.h"
+#include "benchHarness.h"
 
 int main(int argc, char* argv[]) {
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " <array_size>\n";
+    BenchArgs args;
+    if (argc < 2 || !parseBenchArgs(argc, argv, 2, args)) {
+        std::cerr << "Usage: " << argv[0] << " <array_size> " << DISTRIBUTION_USAGE << " [--phases] [--perf] " << MAPPED_FILE_USAGE << "\n";
         return 1;
     }
 
     int n = std::atoi(argv[1]);
-    
-
-    int* arr = new int[n];
-    int* arrCopy = new int[n];
-
-    std::mt19937 gen(static_cast<unsigned int>(std::time(nullptr)));
-    std::uniform_int_distribution<> dist(0, 1000000);
-
-    // Fill array with random values
-    fillRandom(arr, n, gen, dist);
-    std::copy(arr, arr + n, arrCopy);
 
-    auto startA = std::chrono::high_resolution_clock::now();
-    bubbleSort(arr, n);
-    auto endA = std::chrono::high_resolution_clock::now();
-    auto durationA = std::chrono::duration_cast<std::chrono::milliseconds>(endA - startA).count();
-
-    std::copy(arrCopy, arrCopy + n, arr);
-
-    auto startB = std::chrono::high_resolution_clock::now();
-    bubbleSortParallel(arr, n);
-    auto endB = std::chrono::high_resolution_clock::now();
-    auto durationB = std::chrono::duration_cast<std::chrono::milliseconds>(endB - startB).count();
-
-    std::cout << "Bubble Sort time: " << durationA << " ms\n";
-    std::cout << "Bubble Sort Parallel time: " << durationB << " ms\n";
+    BenchData<int> data(args, n);
+    if (!data.valid()) {
+        return 1;
+    }
+    n = data.size();
+    int* arr = data.arr;
 
-    delete[] arr;
-    delete[] arrCopy;
+    BenchReport report(args, data);
+    report.run("Bubble Sort", arr, [&] { bubbleSort(arr, n); });
+    report.run("Bubble Sort Parallel", arr, [&] { bubbleSortParallel(arr, n); });
+    report.run("Bubble Sort Blocked Parallel", arr, [&] { bubbleSortBlocked(arr, n); });
+    report.print();
 
-    return 0;
+    return report.allVerified() ? 0 : 1;
 }
@@ -0,0 +1,192 @@
+#ifndef BUBBLE_SORT_H
+#define BUBBLE_SORT_H
+
+#include <algorithm>
+#include <limits>
+#include <omp.h>
+
+#include "sortRegistry.h"
+
+inline void bubbleSort(int* arr, int arrSize)
+{
+    for(int i=0; i<arrSize; i++)
+    {
+        for(int j=0; j<arrSize-i-1; j++)
+        {
+            if(arr[j+1]<arr[j])
+            {
+                int temp=arr[j];
+                arr[j]=arr[j+1];
+                arr[j+1]=temp;
+            }
+        }
+    }
+}
+
+
+inline void bubbleSortParallel(int* arr, int arrSize)
+/*
+In general bubbleSort is sequential as comparisons move along
+the array. To parallelize this doesn't work.
+
+A possible solution is to first compare even-starting pairs
+and odd-starting pairs. In this manner in the same iteration
+one shift doesn't need to be sequential with the others, then
+you may use openMP for parallel computing.
+
+*/
+{
+    for (int i = 0; i < arrSize; i++)
+    {
+        int phase = i % 2;
+
+        #pragma omp parallel for
+        for (int j = phase; j < arrSize - 1; j += 2)
+        {
+            if (arr[j] > arr[j + 1])
+            {
+                // Swap
+                int temp = arr[j];
+                arr[j] = arr[j + 1];
+                arr[j + 1] = temp;
+            }
+        }
+    }
+}
+
+inline void oddEvenTranspositionSort(int* arr, int arrSize)
+/*
+Same even/odd phases as above, but each pair is written back as
+its min and max instead of being swapped under an if. Without the
+branch the compiler can vectorize every phase.
+*/
+{
+    for (int i = 0; i < arrSize; i++)
+    {
+        #pragma omp simd
+        for (int j = i % 2; j < arrSize - 1; j += 2)
+        {
+            int lo = std::min(arr[j], arr[j + 1]);
+            int hi = std::max(arr[j], arr[j + 1]);
+            arr[j] = lo;
+            arr[j + 1] = hi;
+        }
+    }
+}
+
+inline void mergeSplit(const int* lower, int lowerSize, const int* upper, int upperSize, int* out, bool keepLow)
+/*
+Merges two sorted blocks and writes only one side of the result:
+the lowerSize smallest elements when keepLow is set (merging from
+the front), the upperSize largest otherwise (merging from the back).
+*/
+{
+    if (keepLow)
+    {
+        int i = 0, j = 0;
+        for (int k = 0; k < lowerSize; k++)
+        {
+            if (j >= upperSize || (i < lowerSize && lower[i] <= upper[j]))
+                out[k] = lower[i++];
+            else
+                out[k] = upper[j++];
+        }
+    }
+    else
+    {
+        int i = lowerSize - 1, j = upperSize - 1;
+        for (int k = upperSize - 1; k >= 0; k--)
+        {
+            if (i < 0 || (j >= 0 && upper[j] >= lower[i]))
+                out[k] = upper[j--];
+            else
+                out[k] = lower[i--];
+        }
+    }
+}
+
+inline void bubbleSortBlocked(int* arr, int arrSize)
+/*
+bubbleSortParallel opens a parallel region for every one of its
+arrSize phases, and each phase only compares adjacent pairs, so
+the fork/join overhead is paid n times for O(1) work per element.
+
+Here the odd-even idea is applied to blocks instead of elements,
+inside a single parallel region:
+
+1. Each thread sorts its own contiguous block with the vectorized
+   odd-even transposition sort.
+2. For p phases (p threads), neighbouring blocks are paired up like
+   the elements above (even pairs, then odd pairs). Both threads of
+   a pair merge the two blocks, the left one keeping the smaller
+   half and the right one the larger half (merge-split).
+
+After p phases the blocks are sorted among themselves, the same
+way n element phases sort n elements. That only holds for blocks
+of equal size, so the array is copied into p blocks of ceil(n / p)
+elements with the tail padded with INT_MAX.
+*/
+{
+    if (arrSize < 2)
+        return;
+
+    int* data = nullptr;
+    int* scratch = nullptr;
+    int blockSize = 0;
+
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int p = omp_get_num_threads();
+
+        #pragma omp single
+        {
+            blockSize = (arrSize + p - 1) / p;
+            data = new int[p * blockSize];
+            scratch = new int[p * blockSize];
+        }
+
+        int begin = tid * blockSize;
+        int end = begin + blockSize;
+        int copyEnd = std::min(end, arrSize);
+        if (begin < copyEnd)
+            std::copy(arr + begin, arr + copyEnd, data + begin);
+        std::fill(data + std::max(begin, copyEnd), data + end, std::numeric_limits<int>::max());
+
+        oddEvenTranspositionSort(data + begin, blockSize);
+        #pragma omp barrier
+
+        for (int phase = 0; phase < p; phase++)
+        {
+            int partner = (tid % 2 == phase % 2) ? tid + 1 : tid - 1;
+            bool active = partner >= 0 && partner < p;
+
+            if (active)
+            {
+                int partnerBegin = partner * blockSize;
+                if (tid < partner)
+                    mergeSplit(data + begin, blockSize, data + partnerBegin, blockSize, scratch + begin, true);
+                else
+                    mergeSplit(data + partnerBegin, blockSize, data + begin, blockSize, scratch + begin, false);
+            }
+            // Both halves must be read before either thread overwrites its block
+            #pragma omp barrier
+
+            if (active)
+                std::copy(scratch + begin, scratch + end, data + begin);
+            #pragma omp barrier
+        }
+
+        if (begin < copyEnd)
+            std::copy(data + begin, data + copyEnd, arr + begin);
+    }
+
+    delete[] data;
+    delete[] scratch;
+}
+
+REGISTER_SORT(bubbleSort, "bubbleSort", false, bubbleSort)
+REGISTER_SORT(bubbleSortParallel, "bubbleSort", true, bubbleSortParallel)
+REGISTER_SORT(bubbleSortBlocked, "bubbleSort", true, bubbleSortBlocked)
+
+#endif
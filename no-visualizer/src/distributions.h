@@ -0,0 +1,226 @@
+#ifndef DISTRIBUTIONS_H
+#define DISTRIBUTIONS_H
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <ctime>
+#include <random>
+#include <algorithm>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/* Input distributions for the benchmarks.
+
+Uniform random data hides most of the interesting behaviour: the first-element pivot
+of partitionArray goes quadratic on sorted data, duplicates stress the partitions and
+the merge ties, and presorted runs are what adaptive sorts exploit. Every generator
+takes an explicit seed, so a bad case can be reproduced exactly, and some take a
+parameter (dist-param) whose meaning depends on the distribution:
+
+    uniform      uniform values in 0..1,000,000 (the original fillRandom)
+    sorted       uniform values in ascending order
+    reverse      uniform values in descending order
+    organpipe    ascending first half, descending second half
+    ksorted      sorted, then shuffled inside windows of dist-param elements (default 100)
+    fewunique    dist-param distinct values (default 16)
+    zipf         ranks 1..1,000,000 with Zipf exponent dist-param (default 1.0)
+    allequal     every element is the same value
+    sawtooth     dist-param ascending ramps (default 16) */
+enum class Distribution
+{
+    Uniform,
+    Sorted,
+    Reverse,
+    OrganPipe,
+    KSorted,
+    FewUnique,
+    Zipf,
+    AllEqual,
+    Sawtooth
+};
+
+struct DistributionOptions
+{
+    Distribution distribution = Distribution::Uniform;
+    unsigned int seed = static_cast<unsigned int>(std::time(nullptr));
+    double param = 0;  // 0 selects the distribution's default
+};
+
+const int DISTRIBUTION_MAX_VALUE = 1000000;
+
+const char* const DISTRIBUTION_USAGE =
+    "[--dist uniform|sorted|reverse|organpipe|ksorted|fewunique|zipf|allequal|sawtooth] [--seed N] [--dist-param X]";
+
+const char* const DISTRIBUTION_NAMES[] = {"uniform", "sorted", "reverse", "organpipe", "ksorted",
+                                          "fewunique", "zipf", "allequal", "sawtooth"};
+const int DISTRIBUTION_COUNT = 9;
+
+inline const char* distributionName(Distribution distribution)
+{
+    return DISTRIBUTION_NAMES[static_cast<int>(distribution)];
+}
+
+inline bool parseDistribution(const std::string& name, Distribution& distribution)
+{
+    for(int i = 0; i < DISTRIBUTION_COUNT; i++)
+    {
+        if(name == DISTRIBUTION_NAMES[i])
+        {
+            distribution = static_cast<Distribution>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Applies one of --dist, --seed and --dist-param. Returns false if arg is none of them;
+// valid is cleared when the value is rejected.
+inline bool parseDistributionOption(const std::string& arg, const std::string& value, DistributionOptions& options, bool& valid)
+{
+    if(arg == "--dist")
+    {
+        if(!parseDistribution(value, options.distribution))
+        {
+            std::cerr << "Unknown distribution " << value << "\n";
+            valid = false;
+        }
+    }
+    else if(arg == "--seed")
+    {
+        options.seed = (unsigned int)std::strtoul(value.c_str(), nullptr, 10);
+    }
+    else if(arg == "--dist-param")
+    {
+        options.param = std::atof(value.c_str());
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+inline void fillUniform(int* arr, int size, std::mt19937& gen)
+{
+    std::uniform_int_distribution<> dist(0, DISTRIBUTION_MAX_VALUE);
+    for(int i = 0; i < size; ++i)
+    {
+        arr[i] = dist(gen);
+    }
+}
+
+inline void fillZipf(int* arr, int size, std::mt19937& gen, double exponent)
+{
+    // Inverse transform sampling over the cumulative weights of the ranks
+    std::vector<double> cdf(DISTRIBUTION_MAX_VALUE);
+    double sum = 0;
+    for(int rank = 1; rank <= DISTRIBUTION_MAX_VALUE; rank++)
+    {
+        sum += 1.0 / std::pow((double)rank, exponent);
+        cdf[rank - 1] = sum;
+    }
+    std::uniform_real_distribution<double> dist(0, sum);
+    for(int i = 0; i < size; ++i)
+    {
+        arr[i] = (int)(std::lower_bound(cdf.begin(), cdf.end(), dist(gen)) - cdf.begin()) + 1;
+    }
+}
+
+inline void fillDistribution(int* arr, int size, const DistributionOptions& options)
+{
+    std::mt19937 gen(options.seed);
+    switch(options.distribution)
+    {
+    case Distribution::Uniform:
+        fillUniform(arr, size, gen);
+        break;
+    case Distribution::Sorted:
+        fillUniform(arr, size, gen);
+        std::sort(arr, arr + size);
+        break;
+    case Distribution::Reverse:
+        fillUniform(arr, size, gen);
+        std::sort(arr, arr + size, [](int a, int b) { return a > b; });
+        break;
+    case Distribution::OrganPipe:
+        fillUniform(arr, size, gen);
+        std::sort(arr, arr + size / 2);
+        std::sort(arr + size / 2, arr + size, [](int a, int b) { return a > b; });
+        break;
+    case Distribution::KSorted:
+    {
+        int window = options.param > 0 ? (int)options.param : 100;
+        fillUniform(arr, size, gen);
+        std::sort(arr, arr + size);
+        // Every element ends up less than window positions away from its sorted place
+        for(int begin = 0; begin < size; begin += window)
+        {
+            std::shuffle(arr + begin, arr + std::min(size, begin + window), gen);
+        }
+        break;
+    }
+    case Distribution::FewUnique:
+    {
+        int unique = options.param > 0 ? (int)options.param : 16;
+        std::uniform_int_distribution<> pick(0, unique - 1);
+        for(int i = 0; i < size; ++i)
+        {
+            arr[i] = pick(gen) * (DISTRIBUTION_MAX_VALUE / unique);
+        }
+        break;
+    }
+    case Distribution::Zipf:
+        fillZipf(arr, size, gen, options.param > 0 ? options.param : 1.0);
+        break;
+    case Distribution::AllEqual:
+        std::fill(arr, arr + size, DISTRIBUTION_MAX_VALUE / 2);
+        break;
+    case Distribution::Sawtooth:
+    {
+        int teeth = options.param > 0 ? (int)options.param : 16;
+        int period = std::max(1, size / teeth);
+        for(int i = 0; i < size; ++i)
+        {
+            arr[i] = i % period;
+        }
+        break;
+    }
+    }
+}
+
+/* The other key types of sortLibrary.h get the same shapes: the generated ints are
+mapped onto each type by an order-preserving function that also uses its range
+(int64 keys beyond 32 bits and negative, uint32 keys above INT_MAX, floating point
+keys negative and with a fractional part, all exactly representable). */
+template<typename T>
+inline T keyFromInt(int value)
+{
+    if constexpr(std::is_floating_point<T>::value)
+    {
+        return (T)(value - DISTRIBUTION_MAX_VALUE / 2) / (T)64;
+    }
+    else if constexpr(std::is_signed<T>::value && sizeof(T) == 8)
+    {
+        return (T)(value - DISTRIBUTION_MAX_VALUE / 2) * (T)1000003;
+    }
+    else if constexpr(std::is_unsigned<T>::value && sizeof(T) == 4)
+    {
+        return (T)value * 4093u;
+    }
+    else
+    {
+        return (T)value;
+    }
+}
+
+template<typename T>
+inline void fillDistribution(T* arr, int size, const DistributionOptions& options)
+{
+    std::vector<int> keys(size);
+    fillDistribution(keys.data(), size, options);
+    std::transform(keys.begin(), keys.end(), arr, keyFromInt<T>);
+}
+
+#endif
@@ -0,0 +1,238 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include <chrono>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <omp.h>
+
+#include "quickSort.h"
+#include "mergeSort.h"
+#include "sortLibrary.h"
+#include "externalSort.h"
+#include "benchHarness.h"
+
+/* Sorts a binary file of keys that may not fit in memory (see externalSort.h).
+
+Usage: externalSort <input> <output> [--type int|int64] [--memory 1G] [--engine mergeSortParallel]
+                    [--temp-dir dir] [--no-verify]
+       externalSort --generate <count> <file> [--type int|int64] [distribution options]
+
+--memory is the budget in bytes (K, M and G suffixes are accepted, at least 4M), --engine the
+in-memory engine that sorts the chunks: any sortbench engine for int keys, and
+quickSort, quickSortParallel, mergeSort or mergeSortParallel (from sortLibrary.h)
+for int64 keys. The runs go to --temp-dir, by default the directory of the output.
+After the sort the output is read back (untimed) and checked to be sorted and a
+permutation of the input, unless --no-verify is given.
+
+--generate writes <count> keys from the distributions of the other benchmarks, in
+blocks of 2^24 keys with seeds seed, seed + 1, ... so any size can be generated in
+bounded memory (sorted-like distributions are therefore sorted per block). */
+
+const long long GENERATE_BLOCK = 1 << 24;
+const long long VERIFY_BLOCK = 1 << 22;
+
+bool parseBytes(const std::string& text, size_t& bytes) {
+    char* end = nullptr;
+    double value = std::strtod(text.c_str(), &end);
+    std::string suffix = end;
+    if (suffix == "K" || suffix == "k") value *= 1024.0;
+    else if (suffix == "M" || suffix == "m") value *= 1024.0 * 1024.0;
+    else if (suffix == "G" || suffix == "g") value *= 1024.0 * 1024.0 * 1024.0;
+    else if (!suffix.empty()) return false;
+    bytes = (size_t)value;
+    return value > 0;
+}
+
+template<typename T>
+bool generateFile(const std::string& path, long long count, const DistributionOptions& input) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << externalError("cannot create", path) << "\n";
+        return false;
+    }
+    std::vector<T> keys(std::min(count, GENERATE_BLOCK));
+    DistributionOptions block = input;
+    for (long long done = 0; done < count; done += GENERATE_BLOCK) {
+        int n = (int)std::min(GENERATE_BLOCK, count - done);
+        fillDistribution(keys.data(), n, block);
+        block.seed++;
+        if (!writeBlock(fd, keys.data(), n * sizeof(T))) {
+            std::cerr << externalError("cannot write", path) << "\n";
+            ::close(fd);
+            return false;
+        }
+    }
+    ::close(fd);
+    return true;
+}
+
+// Reads a key file block by block; sortedness is checked across block boundaries
+template<typename T>
+bool scanFile(const std::string& path, unsigned long long& checksum, bool& sorted) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << externalError("cannot open", path) << "\n";
+        return false;
+    }
+    std::vector<T> keys(VERIFY_BLOCK);
+    checksum = 0;
+    sorted = true;
+    bool first = true;
+    T last = T();
+    long long bytes;
+    while ((bytes = readBlock(fd, keys.data(), VERIFY_BLOCK * sizeof(T))) > 0) {
+        int n = (int)(bytes / sizeof(T));
+        checksum += permutationChecksum(keys.data(), n);
+        sorted = sorted && isSorted(keys.data(), n) && (first || !(keys[0] < last));
+        last = keys[n - 1];
+        first = false;
+    }
+    ::close(fd);
+    return bytes == 0;
+}
+
+template<typename T>
+int runExternal(const std::string& inputPath, const std::string& outputPath, size_t memory,
+                const std::string& tempDir, typename ExternalSorter<T>::ChunkSort sortChunk, bool verify) {
+    unsigned long long inputChecksum = 0;
+    bool inputSorted;
+    if (verify && !scanFile<T>(inputPath, inputChecksum, inputSorted)) {
+        return 1;
+    }
+
+    ExternalSortStats stats;
+    bool ok;
+    {
+        ExternalSorter<T> sorter(memory, tempDir, sortChunk);
+        ok = sorter.sort(inputPath, outputPath, stats);
+    }
+    if (!ok) {
+        std::cerr << "External sort failed: " << stats.error << "\n";
+        return 1;
+    }
+
+    std::cout << "Run Generation time: " << stats.runs.wallNs << " ns\n";
+    std::cout << "Merge time: " << stats.merge.wallNs << " ns\n";
+
+    long long total = stats.runs.wallNs + stats.merge.wallNs;
+    bool verified = true;
+    if (verify) {
+        unsigned long long outputChecksum = 0;
+        bool sorted;
+        if (!scanFile<T>(outputPath, outputChecksum, sorted)) {
+            return 1;
+        }
+        bool permutation = outputChecksum == inputChecksum;
+        verified = sorted && permutation;
+        if (!verified) {
+            std::cout << "External Sort time: FAILED (" << (sorted ? "" : "not sorted")
+                      << (!sorted && !permutation ? ", " : "")
+                      << (permutation ? "" : "not a permutation of the input") << ")\n";
+        }
+    }
+    if (verified) {
+        std::cout << "External Sort time: " << total << " ns\n";
+    }
+
+    std::cout << "Run Generation breakdown: sort " << stats.runs.cpuNs << " ns, I/O " << stats.runs.ioNs
+              << " ns, " << stats.runCount << " runs of up to " << stats.chunkElements << " keys\n";
+    std::cout << "Merge breakdown: merge " << stats.merge.cpuNs << " ns, I/O " << stats.merge.ioNs
+              << " ns, " << stats.mergePasses << " passes, fan-in up to " << stats.fanIn << "\n";
+
+    return verified ? 0 : 1;
+}
+
+// The int64 engines come from the templated library
+bool int64Engine(const std::string& name, ExternalSorter<int64_t>::ChunkSort& sortChunk) {
+    if (name == "quickSort") sortChunk = [](int64_t* a, int n) { sortlib::quickSort(a, a + n); };
+    else if (name == "quickSortParallel") sortChunk = [](int64_t* a, int n) { sortlib::quickSortParallel(a, a + n); };
+    else if (name == "mergeSort") sortChunk = [](int64_t* a, int n) { sortlib::mergeSort(a, a + n); };
+    else if (name == "mergeSortParallel") sortChunk = [](int64_t* a, int n) { sortlib::mergeSortParallel(a, a + n); };
+    else return false;
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    const char* usage = " <input> <output> [--type int|int64] [--memory 1G] [--engine mergeSortParallel]"
+                        " [--temp-dir dir] [--no-verify]\n       ";
+    bool generate = argc > 1 && std::string(argv[1]) == "--generate";
+    int first = generate ? 4 : 3;
+    if (argc < first) {
+        std::cerr << "Usage: " << argv[0] << usage << argv[0] << " --generate <count> <file> [--type int|int64] "
+                  << DISTRIBUTION_USAGE << "\n";
+        return 1;
+    }
+
+    std::string type = "int";
+    std::string engine = "mergeSortParallel";
+    std::string tempDir;
+    size_t memory = (size_t)1 << 30;
+    bool verify = true;
+    DistributionOptions input;
+    for (int i = first; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--no-verify") {
+            verify = false;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            return 1;
+        }
+        std::string value = argv[++i];
+        bool valid = true;
+        if (arg == "--type") type = value;
+        else if (arg == "--engine") engine = value;
+        else if (arg == "--temp-dir") tempDir = value;
+        else if (arg == "--memory") valid = parseBytes(value, memory);
+        else if (!parseDistributionOption(arg, value, input, valid)) {
+            std::cerr << "Unknown option " << arg << "\n";
+            return 1;
+        }
+        if (!valid) {
+            std::cerr << "Invalid value " << value << " for " << arg << "\n";
+            return 1;
+        }
+        if (arg == "--memory" && memory < EXTERNAL_MIN_MEMORY) {
+            std::cerr << "Invalid value " << value << " for --memory, the budget must be at least "
+                      << EXTERNAL_MIN_MEMORY / (1 << 20) << "M\n";
+            return 1;
+        }
+    }
+    if (type != "int" && type != "int64") {
+        std::cerr << "Unknown key type " << type << ", expected int or int64\n";
+        return 1;
+    }
+
+    if (generate) {
+        long long count = std::atoll(argv[2]);
+        bool ok = type == "int" ? generateFile<int>(argv[3], count, input) : generateFile<int64_t>(argv[3], count, input);
+        return ok ? 0 : 1;
+    }
+
+    std::string inputPath = argv[1];
+    std::string outputPath = argv[2];
+    if (tempDir.empty()) {
+        size_t slash = outputPath.rfind('/');
+        tempDir = slash == std::string::npos ? "." : outputPath.substr(0, std::max<size_t>(slash, 1));
+    }
+
+    if (type == "int") {
+        const SortEngine* sortEngine = findSortEngine(engine);
+        if (sortEngine == nullptr) {
+            std::cerr << "Unknown engine " << engine << "\n";
+            return 1;
+        }
+        return runExternal<int>(inputPath, outputPath, memory, tempDir, sortEngine->run, verify);
+    }
+    ExternalSorter<int64_t>::ChunkSort sortChunk;
+    if (!int64Engine(engine, sortChunk)) {
+        std::cerr << "Unknown int64 engine " << engine << ", expected quickSort, quickSortParallel, mergeSort or mergeSortParallel\n";
+        return 1;
+    }
+    return runExternal<int64_t>(inputPath, outputPath, memory, tempDir, sortChunk, verify);
+}
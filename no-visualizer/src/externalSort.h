@@ -0,0 +1,472 @@
+#ifndef EXTERNAL_SORT_H
+#define EXTERNAL_SORT_H
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <memory>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+/* External-memory sort of a binary file of keys (native-endian int32 or int64).
+
+The benchmark binaries sort arrays that fit in memory. externalSort sorts a file of
+any size within a memory budget, in two phases:
+
+1. Run generation. The input is read in chunks of a quarter of the budget and every
+   chunk is sorted by an in-memory engine (the parallel quick or merge sort) and
+   written to a temporary run file. Three chunk buffers rotate, so while chunk i is
+   sorted, chunk i + 1 is read and run i - 1 is written by I/O threads; the last
+   quarter of the budget is left to the engine's own scratch memory.
+2. Merge. The runs are merged k at a time through a min-heap of their heads. Every run
+   gets an input buffer of budget / (k + 2) bytes, refilled with one large sequential
+   read, and the output goes through two buffers of the same size: one is written by
+   an I/O thread while the merge fills the other. k is limited so every buffer stays
+   at least EXTERNAL_MIN_BUFFER bytes and the open run files stay EXTERNAL_FD_HEADROOM
+   below the process's file descriptor limit; with more runs than that, extra passes
+   merge groups of k runs into longer runs first.
+
+Every phase reports its wall time, the time spent inside read and write calls (on
+all threads, so I/O that overlaps the sort counts fully) and the CPU time of the
+sorting or merging thread. Errors (a file that cannot be opened, a short write, ...)
+stop the sort: the functions return false and describe the failure in
+ExternalSortStats::error. */
+const size_t EXTERNAL_MIN_BUFFER = 1 << 20;  // smallest per-run merge buffer, in bytes
+const size_t EXTERNAL_MIN_MEMORY = 4 * EXTERNAL_MIN_BUFFER;  // smallest budget the binary accepts
+const size_t EXTERNAL_FD_HEADROOM = 16;     // descriptors left for the output file, stdio, ...
+
+struct ExternalPhaseStats
+{
+    long long wallNs = 0;
+    long long ioNs = 0;   // inside read / write, summed over the threads
+    long long cpuNs = 0;  // sorting or merging
+};
+
+struct ExternalSortStats
+{
+    ExternalPhaseStats runs;
+    ExternalPhaseStats merge;
+    long long elements = 0;
+    long long chunkElements = 0;
+    int runCount = 0;
+    int mergePasses = 0;
+    int fanIn = 0;
+    std::string error;
+};
+
+inline long long externalElapsedNs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Reads up to bytes, stopping early only at the end of the file; returns -1 on an error
+inline long long readBlock(int fd, void* buffer, size_t bytes)
+{
+    size_t done = 0;
+    while(done < bytes)
+    {
+        ssize_t got = ::read(fd, (char*)buffer + done, bytes - done);
+        if(got < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if(got < 0)
+        {
+            return -1;
+        }
+        if(got == 0)
+        {
+            break;
+        }
+        done += got;
+    }
+    return (long long)done;
+}
+
+inline bool writeBlock(int fd, const void* buffer, size_t bytes)
+{
+    size_t done = 0;
+    while(done < bytes)
+    {
+        ssize_t put = ::write(fd, (const char*)buffer + done, bytes - done);
+        if(put < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if(put <= 0)
+        {
+            return false;
+        }
+        done += put;
+    }
+    return true;
+}
+
+inline std::string externalError(const std::string& what, const std::string& path)
+{
+    return what + " " + path + ": " + std::strerror(errno);
+}
+
+/* One external sort. T is the key type, sortChunk(keys, n) the in-memory engine.
+The I/O threads add their time to ioNs through the atomic counter. */
+template<typename T>
+class ExternalSorter
+{
+public:
+    typedef std::function<void(T*, int)> ChunkSort;
+
+    ExternalSorter(size_t memoryBytes, const std::string& tempDir, ChunkSort sortChunk)
+        : memoryBytes(memoryBytes), tempDir(tempDir), sortChunk(sortChunk)
+    {
+    }
+
+    ~ExternalSorter()
+    {
+        for(const std::string& run : runs)
+        {
+            std::remove(run.c_str());
+        }
+    }
+
+    bool sort(const std::string& inputPath, const std::string& outputPath, ExternalSortStats& stats)
+    {
+        auto start = std::chrono::steady_clock::now();
+        ioNs = 0;
+        bool ok = generateRuns(inputPath, stats);
+        stats.runs.ioNs = ioNs;
+        stats.runs.wallNs = externalElapsedNs(start);
+        if(!ok)
+        {
+            return false;
+        }
+
+        start = std::chrono::steady_clock::now();
+        ioNs = 0;
+        ok = mergeAll(outputPath, stats);
+        stats.merge.ioNs = ioNs;
+        stats.merge.wallNs = externalElapsedNs(start);
+        return ok;
+    }
+
+private:
+    struct Chunk
+    {
+        std::unique_ptr<T[]> keys;
+        long long count = 0;
+    };
+
+    // A run being merged: its file and the buffered part of it
+    struct RunReader
+    {
+        int fd = -1;
+        std::unique_ptr<T[]> buffer;
+        long long count = 0;
+        long long pos = 0;
+    };
+
+    long long timedRead(int fd, T* keys, long long count)
+    {
+        auto start = std::chrono::steady_clock::now();
+        long long bytes = readBlock(fd, keys, count * sizeof(T));
+        ioNs += externalElapsedNs(start);
+        return bytes < 0 ? -1 : bytes / (long long)sizeof(T);
+    }
+
+    bool timedWrite(int fd, const T* keys, long long count)
+    {
+        auto start = std::chrono::steady_clock::now();
+        bool ok = writeBlock(fd, keys, count * sizeof(T));
+        ioNs += externalElapsedNs(start);
+        return ok;
+    }
+
+    std::string newRunPath()
+    {
+        std::string path = tempDir + "/externalSort." + std::to_string(getpid()) + "." +
+                           std::to_string(nextRun++) + ".run";
+        runs.push_back(path);
+        return path;
+    }
+
+    void removeRuns(size_t first, size_t last)
+    {
+        for(size_t i = first; i < last; i++)
+        {
+            std::remove(runs[i].c_str());
+        }
+        runs.erase(runs.begin() + first, runs.begin() + last);
+    }
+
+    bool writeRun(const T* keys, long long count, std::string& error)
+    {
+        // Only one run is written at a time, so the run list needs no lock
+        std::string path = newRunPath();
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if(fd < 0)
+        {
+            error = externalError("cannot create run file", path);
+            return false;
+        }
+        bool ok = timedWrite(fd, keys, count);
+        if(!ok)
+        {
+            error = externalError("cannot write run file", path);
+        }
+        ::close(fd);
+        return ok;
+    }
+
+    bool generateRuns(const std::string& inputPath, ExternalSortStats& stats)
+    {
+        int fd = ::open(inputPath.c_str(), O_RDONLY);
+        if(fd < 0)
+        {
+            stats.error = externalError("cannot open", inputPath);
+            return false;
+        }
+
+        long long chunk = std::max<long long>(1, std::min<long long>(memoryBytes / (4 * sizeof(T)), INT_MAX));
+        stats.chunkElements = chunk;
+        Chunk buffers[3];
+        for(Chunk& buffer : buffers)
+        {
+            buffer.keys.reset(new T[chunk]);
+        }
+
+        // Buffer b holds the chunk being sorted, b + 1 the one being read, b + 2 the run being written
+        int b = 0;
+        buffers[0].count = timedRead(fd, buffers[0].keys.get(), chunk);
+        std::future<bool> writing;
+        std::string writeError;
+        bool ok = buffers[0].count >= 0;
+        while(ok && buffers[b].count > 0)
+        {
+            Chunk& current = buffers[b];
+            Chunk& next = buffers[(b + 1) % 3];
+            std::future<long long> reading = std::async(std::launch::async, [this, fd, &next, chunk] {
+                return timedRead(fd, next.keys.get(), chunk);
+            });
+
+            auto start = std::chrono::steady_clock::now();
+            sortChunk(current.keys.get(), (int)current.count);
+            stats.runs.cpuNs += externalElapsedNs(start);
+
+            if(writing.valid() && !writing.get())
+            {
+                ok = false;
+            }
+            next.count = reading.get();
+            if(next.count < 0)
+            {
+                stats.error = externalError("cannot read", inputPath);
+                ok = false;
+            }
+
+            stats.elements += current.count;
+            stats.runCount++;
+            writing = std::async(std::launch::async, [this, &current, &writeError] {
+                return writeRun(current.keys.get(), current.count, writeError);
+            });
+            b = (b + 1) % 3;
+        }
+        if(writing.valid() && !writing.get())
+        {
+            ok = false;
+        }
+        if(!writeError.empty())
+        {
+            stats.error = writeError;
+        }
+        ::close(fd);
+        return ok;
+    }
+
+    // Merges runs [first, last) into the file at outputPath with bufferElements keys per buffer
+    bool mergeRuns(size_t first, size_t last, const std::string& outputPath, long long bufferElements,
+                   ExternalSortStats& stats)
+    {
+        int out = ::open(outputPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if(out < 0)
+        {
+            stats.error = externalError("cannot create", outputPath);
+            return false;
+        }
+
+        size_t k = last - first;
+        std::vector<RunReader> readers(k);
+        bool ok = true;
+        for(size_t r = 0; r < k && ok; r++)
+        {
+            readers[r].fd = ::open(runs[first + r].c_str(), O_RDONLY);
+            readers[r].buffer.reset(new T[bufferElements]);
+            readers[r].count = readers[r].fd < 0 ? -1 : timedRead(readers[r].fd, readers[r].buffer.get(), bufferElements);
+            if(readers[r].count < 0)
+            {
+                stats.error = externalError("cannot read run file", runs[first + r]);
+                ok = false;
+            }
+        }
+
+        std::unique_ptr<T[]> output[2] = {std::unique_ptr<T[]>(new T[bufferElements]),
+                                          std::unique_ptr<T[]>(new T[bufferElements])};
+        int o = 0;
+        long long filled = 0;
+        std::future<bool> writing;
+        auto flush = [&] {
+            if(writing.valid() && !writing.get())
+            {
+                ok = false;
+            }
+            const T* keys = output[o].get();
+            long long count = filled;
+            writing = std::async(std::launch::async, [this, out, keys, count] {
+                return timedWrite(out, keys, count);
+            });
+            o ^= 1;
+            filled = 0;
+        };
+
+        // Min-heap of (head key, run); ties go to the lower run, which keeps the merge stable
+        typedef std::pair<T, size_t> Head;
+        std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+        for(size_t r = 0; r < k && ok; r++)
+        {
+            if(readers[r].count > 0)
+            {
+                heads.push(Head(readers[r].buffer[0], r));
+            }
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        long long refillNs = 0;
+        while(ok && !heads.empty())
+        {
+            Head head = heads.top();
+            heads.pop();
+            output[o][filled++] = head.first;
+            if(filled == bufferElements)
+            {
+                auto wait = std::chrono::steady_clock::now();
+                flush();
+                refillNs += externalElapsedNs(wait);
+            }
+
+            RunReader& reader = readers[head.second];
+            if(++reader.pos == reader.count)
+            {
+                auto wait = std::chrono::steady_clock::now();
+                reader.count = timedRead(reader.fd, reader.buffer.get(), bufferElements);
+                reader.pos = 0;
+                refillNs += externalElapsedNs(wait);
+                if(reader.count < 0)
+                {
+                    stats.error = externalError("cannot read run file", runs[first + head.second]);
+                    ok = false;
+                }
+            }
+            if(reader.count > 0)
+            {
+                heads.push(Head(reader.buffer[reader.pos], head.second));
+            }
+        }
+        // The merging thread's time without the time it spent blocked on reads and writes
+        stats.merge.cpuNs += externalElapsedNs(start) - refillNs;
+
+        if(ok && filled > 0)
+        {
+            flush();
+        }
+        if(writing.valid() && !writing.get())
+        {
+            ok = false;
+        }
+        if(!ok && stats.error.empty())
+        {
+            stats.error = externalError("cannot write", outputPath);
+        }
+        for(RunReader& reader : readers)
+        {
+            if(reader.fd >= 0)
+            {
+                ::close(reader.fd);
+            }
+        }
+        ::close(out);
+        return ok;
+    }
+
+    long long mergeBufferElements(size_t k) const
+    {
+        return std::max<long long>(1, memoryBytes / ((k + 2) * sizeof(T)));
+    }
+
+    // Number of runs merged at once, at least 2
+    size_t mergeFanIn() const
+    {
+        size_t buffers = memoryBytes / EXTERNAL_MIN_BUFFER;
+        size_t fanIn = buffers >= 4 ? buffers - 2 : 2;
+        rlimit files;
+        if(getrlimit(RLIMIT_NOFILE, &files) == 0 && files.rlim_cur != RLIM_INFINITY &&
+           files.rlim_cur > EXTERNAL_FD_HEADROOM)
+        {
+            fanIn = std::min<size_t>(fanIn, files.rlim_cur - EXTERNAL_FD_HEADROOM);
+        }
+        return std::max<size_t>(2, fanIn);
+    }
+
+    bool mergeAll(const std::string& outputPath, ExternalSortStats& stats)
+    {
+        size_t fanIn = mergeFanIn();
+        stats.fanIn = (int)fanIn;
+
+        // Intermediate passes: merge the runs of the pass fanIn at a time into longer runs,
+        // which are appended behind the ones still to be merged
+        while(runs.size() > fanIn)
+        {
+            stats.mergePasses++;
+            size_t remaining = runs.size();
+            while(remaining > 0)
+            {
+                size_t count = std::min(fanIn, remaining);
+                remaining -= count;
+                if(count == 1)
+                {
+                    // A single leftover run goes to the next pass as it is
+                    std::rotate(runs.begin(), runs.begin() + 1, runs.end());
+                    continue;
+                }
+                std::string merged = newRunPath();
+                if(!mergeRuns(0, count, merged, mergeBufferElements(count), stats))
+                {
+                    return false;
+                }
+                removeRuns(0, count);
+            }
+        }
+
+        stats.mergePasses++;
+        bool ok = mergeRuns(0, runs.size(), outputPath, mergeBufferElements(runs.size()), stats);
+        removeRuns(0, runs.size());
+        return ok;
+    }
+
+    size_t memoryBytes;
+    std::string tempDir;
+    ChunkSort sortChunk;
+    std::vector<std::string> runs;  // run files not merged yet, oldest first
+    int nextRun = 0;
+    std::atomic<long long> ioNs{0};
+};
+
+#endif
@@ -0,0 +1,37 @@
+#include <iostream>
+#include <cstdlib>
+#include <ctime>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <vector>
+#include <omp.h>
+
+#include "heapSort.h"
+#include "benchHarness.h"
+
+int main(int argc, char* argv[]) {
+    BenchArgs args;
+    if (argc < 2 || !parseBenchArgs(argc, argv, 2, args)) {
+        std::cerr << "Usage: " << argv[0] << " <array_size> " << DISTRIBUTION_USAGE << " [--phases] [--perf] " << MAPPED_FILE_USAGE << "\n";
+        return 1;
+    }
+
+    int n = std::atoi(argv[1]);
+
+    BenchData<int> data(args, n);
+    if (!data.valid()) {
+        return 1;
+    }
+    n = data.size();
+    int* arr = data.arr;
+
+    BenchReport report(args, data);
+    report.run("Heap Sort", arr, [&] { heapSort(arr, n); });
+    report.run("Heap Sort Parallel", arr, [&] { heapSortParallel(arr, n); });
+    report.run("Heap Sort Binary", arr, [&] { heapSortDary<2>(arr, n); });
+    report.run("Heap Sort Eight-Way", arr, [&] { heapSortDary<8>(arr, n); });
+    report.print();
+
+    return report.allVerified() ? 0 : 1;
+}
@@ -0,0 +1,45 @@
+#include <iostream>
+#include <cstdlib>
+#include <ctime>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <vector>
+#include <omp.h>
+
+#include "insertionSort.h"
+#include "benchHarness.h"
+
+// Above this size only the Shellsorts are timed, the quadratic insertion sorts would take hours
+const int INSERTION_BENCH_MAX = 1 << 18;
+
+int main(int argc, char* argv[]) {
+    BenchArgs args;
+    if (argc < 2 || !parseBenchArgs(argc, argv, 2, args)) {
+        std::cerr << "Usage: " << argv[0] << " <array_size> " << DISTRIBUTION_USAGE << " [--phases] [--perf] " << MAPPED_FILE_USAGE << "\n";
+        return 1;
+    }
+
+    int n = std::atoi(argv[1]);
+
+    BenchData<int> data(args, n);
+    if (!data.valid()) {
+        return 1;
+    }
+    n = data.size();
+    int* arr = data.arr;
+
+    BenchReport report(args, data);
+    report.run("Shell Sort", arr, [&] { shellSort(arr, n, ShellGaps::Ciura); });
+    report.run("Shell Sort Parallel", arr, [&] { shellSortParallel(arr, n); });
+    report.run("Shell Sort Tokuda", arr, [&] { shellSort(arr, n, ShellGaps::Tokuda); });
+    if (n <= INSERTION_BENCH_MAX) {
+        report.run("Binary Insertion Sort", arr, [&] { binaryInsertionSort(arr, n); });
+        report.run("Insertion Sort", arr, [&] { insertionSort(arr, 0, n-1); });
+    } else {
+        std::cerr << "Skipping the insertion sorts above " << INSERTION_BENCH_MAX << " elements\n";
+    }
+    report.print();
+
+    return report.allVerified() ? 0 : 1;
+}
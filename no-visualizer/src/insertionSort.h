@@ -0,0 +1,156 @@
+#ifndef INSERTION_SORT_H
+#define INSERTION_SORT_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <omp.h>
+
+#include "phaseTimer.h"
+#include "quickSort.h"
+#include "sortRegistry.h"
+
+/* The insertion sort family.
+
+Insertion sort finishes the small ranges of intro sort (insertionSort in quickSort.h,
+which shifts one element per comparison) and of most hybrid sorts, so it is timed here
+on its own together with two relatives:
+
+- binaryInsertionSort finds the position of every new element with a binary search
+  over the sorted prefix (upper_bound, so equal keys keep their order) and shifts the
+  tail of the prefix with one memmove, which the C library does with vector loads and
+  stores. It does O(n log n) comparisons instead of O(n^2), the moves stay quadratic.
+- shellSort runs gapped insertion sorts with decreasing gaps h, each pass leaving every
+  h-th subsequence sorted, and ends with a plain insertion sort (h = 1) on nearly
+  sorted data. Two gap sequences: Ciura's experimentally found 1, 4, 10, 23, 57, 132,
+  301, 701, 1750, extended by a factor of 2.25, and Tokuda's
+  ceil((9 (9/4)^k - 4) / 5) = 1, 4, 9, 20, 46, 103, ...
+- shellSortParallel uses the Ciura gaps. The h subsequences of a pass are independent,
+  so each thread takes a contiguous block of them (residues r of i mod h) and walks
+  its block row by row, i = row * h + r, which keeps every row of the block in
+  consecutive memory. Passes with a gap smaller than SHELL_PARALLEL_MIN_GAP times the
+  number of threads would give the threads too little work and run serially, the last
+  ones included. */
+enum class ShellGaps
+{
+    Ciura,
+    Tokuda
+};
+
+const int SHELL_PARALLEL_MIN_GAP = 64;  // subsequences per thread for a parallel pass
+
+// Gaps smaller than n, largest first
+inline std::vector<int> shellGaps(ShellGaps sequence, int n)
+{
+    std::vector<int> gaps;
+    if(sequence == ShellGaps::Ciura)
+    {
+        const int ciura[] = {1, 4, 10, 23, 57, 132, 301, 701, 1750};
+        double gap = 1;
+        for(int k = 0; gap < n; k++)
+        {
+            gap = k < 9 ? ciura[k] : gap * 2.25;
+            if(gap < n)
+            {
+                gaps.push_back((int)gap);
+            }
+        }
+    }
+    else
+    {
+        double power = 1;
+        for(int gap = 1; gap < n; )
+        {
+            gaps.push_back(gap);
+            power *= 2.25;
+            gap = (int)std::ceil((9.0 * power - 4.0) / 5.0);
+        }
+    }
+    if(gaps.empty())
+    {
+        gaps.push_back(1);
+    }
+    std::reverse(gaps.begin(), gaps.end());
+    return gaps;
+}
+
+inline void binaryInsertionSort(int a[], int n)
+{
+    PhaseTimer timer(PHASE_LEAF);
+    for(int i = 1; i < n; i++)
+    {
+        int value = a[i];
+        if(a[i - 1] <= value)
+        {
+            continue;
+        }
+        int pos = (int)(std::upper_bound(a, a + i - 1, value) - a);
+        std::memmove(a + pos + 1, a + pos, (size_t)(i - pos) * sizeof(int));
+        a[pos] = value;
+    }
+}
+
+// Insertion sort of the subsequences a[r], a[r + gap], ... for every residue r in [rBegin, rEnd)
+inline void shellPass(int a[], int n, int gap, int rBegin, int rEnd)
+{
+    for(int row = gap; row < n; row += gap)
+    {
+        int end = std::min(row + rEnd, n);
+        for(int i = row + rBegin; i < end; i++)
+        {
+            int value = a[i];
+            int j = i;
+            while(j >= gap && a[j - gap] > value)
+            {
+                a[j] = a[j - gap];
+                j -= gap;
+            }
+            a[j] = value;
+        }
+    }
+}
+
+inline void shellSort(int a[], int n, ShellGaps sequence)
+{
+    PhaseTimer timer(PHASE_LEAF);
+    for(int gap : shellGaps(sequence, n))
+    {
+        shellPass(a, n, gap, 0, gap);
+    }
+}
+
+inline void shellSortParallel(int a[], int n)
+{
+    std::vector<int> gaps = shellGaps(ShellGaps::Ciura, n);
+
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        for(int gap : gaps)
+        {
+            if(gap >= SHELL_PARALLEL_MIN_GAP * nthreads)
+            {
+                PhaseTimer timer(PHASE_LEAF);
+                int rBegin = (int)((long long)gap * tid / nthreads);
+                int rEnd = (int)((long long)gap * (tid + 1) / nthreads);
+                shellPass(a, n, gap, rBegin, rEnd);
+            }
+            else if(tid == 0)
+            {
+                PhaseTimer timer(PHASE_LEAF);
+                shellPass(a, n, gap, 0, gap);
+            }
+            #pragma omp barrier
+        }
+    }
+}
+
+REGISTER_SORT(insertionSort, "insertionSort", false, [](int* a, int n) { insertionSort(a, 0, n - 1); })
+REGISTER_SORT(binaryInsertionSort, "insertionSort", false, binaryInsertionSort)
+REGISTER_SORT(shellSort, "insertionSort", false, [](int* a, int n) { shellSort(a, n, ShellGaps::Ciura); })
+REGISTER_SORT(shellSortTokuda, "insertionSort", false, [](int* a, int n) { shellSort(a, n, ShellGaps::Tokuda); })
+REGISTER_SORT(shellSortParallel, "insertionSort", true, shellSortParallel)
+
+#endif
@@ -0,0 +1,331 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <iostream>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/* Sorting key files through mmap (the --input / --output options of the binaries).
+
+With --input the keys come from a binary file of little-endian values of the key type
+instead of a generator. The file is mapped read-only and serves directly as the input
+of every run, nothing is read into a heap buffer:
+- without --output every run sorts a private writable mapping of the input file, in
+  place. Before each run the mapping is replaced (MAP_FIXED, same address) by a fresh
+  one, which shows the original file contents again, so resetting the input copies
+  nothing and the file itself is never modified;
+- with --output the output file is created with the size of the input and mapped
+  shared; every run copies the input mapping into it and sorts it there, so the file
+  holds the sorted keys when the binary exits.
+
+Page faults are kept out of the sort time: after the mapping is (re)created its pages
+are faulted in before the timer starts, with MAP_POPULATE (--fault populate, the
+default) or by writing to one element per page (--fault touch), and that time is
+reported on its own as the run's page-in time. --fault lazy skips the prefault, so the
+faults land in the sort time like first-touch faults of fresh heap memory. --madvise
+passes a hint (normal, sequential, random, willneed, hugepage) for both mappings. The
+page-in line also shows the minor and major faults taken during the sort itself. */
+enum class FaultMode
+{
+    Populate,
+    Touch,
+    Lazy
+};
+
+struct MappedFileOptions
+{
+    std::string input;
+    std::string output;
+    FaultMode fault = FaultMode::Populate;
+    std::string advice;  // empty: no madvise
+};
+
+const char* const MAPPED_FILE_USAGE =
+    "[--input file [--output file] [--fault populate|touch|lazy] [--madvise normal|sequential|random|willneed|hugepage]]";
+
+// Applies one of --input, --output, --fault and --madvise. Returns false if arg is none of them;
+// valid is cleared when the value is rejected.
+inline bool parseMappedFileOption(const std::string& arg, const std::string& value, MappedFileOptions& options, bool& valid)
+{
+    if(arg == "--input")
+    {
+        options.input = value;
+    }
+    else if(arg == "--output")
+    {
+        options.output = value;
+    }
+    else if(arg == "--fault")
+    {
+        if(value == "populate")
+        {
+            options.fault = FaultMode::Populate;
+        }
+        else if(value == "touch")
+        {
+            options.fault = FaultMode::Touch;
+        }
+        else if(value == "lazy")
+        {
+            options.fault = FaultMode::Lazy;
+        }
+        else
+        {
+            std::cerr << "Unknown fault mode " << value << ", expected populate, touch or lazy\n";
+            valid = false;
+        }
+    }
+    else if(arg == "--madvise")
+    {
+        if(value != "normal" && value != "sequential" && value != "random" && value != "willneed" && value != "hugepage")
+        {
+            std::cerr << "Unknown madvise hint " << value << "\n";
+            valid = false;
+        }
+        options.advice = value;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+struct FaultCount
+{
+    long long minor = 0;
+    long long major = 0;
+};
+
+inline FaultCount processFaults()
+{
+    FaultCount count;
+#ifdef __linux__
+    rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) == 0)
+    {
+        count.minor = usage.ru_minflt;
+        count.major = usage.ru_majflt;
+    }
+#endif
+    return count;
+}
+
+template<typename T>
+class MappedKeys
+{
+public:
+    MappedKeys() = default;
+    MappedKeys(const MappedKeys&) = delete;
+    MappedKeys& operator=(const MappedKeys&) = delete;
+
+    ~MappedKeys()
+    {
+        close();
+    }
+
+    // Maps the first limit keys of the input file (all of them when limit is 0); false and error() on failure
+    bool open(const MappedFileOptions& options, long long limit)
+    {
+        this->options = options;
+#if defined(__linux__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        inputFd = ::open(options.input.c_str(), O_RDONLY);
+        struct stat info;
+        if(inputFd < 0 || fstat(inputFd, &info) != 0)
+        {
+            return fail("cannot open " + options.input);
+        }
+        long long keys = (long long)info.st_size / (long long)sizeof(T);
+        if(limit > keys)
+        {
+            failure = options.input + " holds only " + std::to_string(keys) + " keys";
+            return false;
+        }
+        count = limit > 0 ? limit : keys;
+        bytes = (size_t)count * sizeof(T);
+        if(count == 0)
+        {
+            return true;
+        }
+
+        inputKeys = (T*)map(nullptr, PROT_READ, MAP_SHARED, inputFd);
+        if(inputKeys == nullptr)
+        {
+            return fail("cannot map " + options.input);
+        }
+        if(!options.output.empty())
+        {
+            outputFd = ::open(options.output.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+            if(outputFd < 0 || ftruncate(outputFd, (off_t)bytes) != 0)
+            {
+                return fail("cannot create " + options.output);
+            }
+        }
+        sortKeys = (T*)map(nullptr, PROT_READ | PROT_WRITE, sortFlags(), sortFd());
+        if(sortKeys == nullptr)
+        {
+            return fail("cannot map the sort buffer of " + options.input);
+        }
+        return true;
+#else
+        (void)limit;
+        failure = "--input needs mmap on a little-endian Linux host";
+        return false;
+#endif
+    }
+
+    const std::string& error() const
+    {
+        return failure;
+    }
+
+    long long size() const
+    {
+        return count;
+    }
+
+    const T* input() const
+    {
+        return inputKeys;
+    }
+
+    T* data()
+    {
+        return sortKeys;
+    }
+
+    // Gives the next run a fresh copy of the input in data(); returns the page-in time in ns
+    long long reset()
+    {
+        if(count == 0)
+        {
+            return 0;
+        }
+        auto start = std::chrono::steady_clock::now();
+#ifdef __linux__
+        if(map(sortKeys, PROT_READ | PROT_WRITE, sortFlags() | MAP_FIXED, sortFd()) == nullptr)
+        {
+            std::cerr << "cannot remap the sort buffer: " << std::strerror(errno) << "\n";
+            std::exit(1);
+        }
+        if(options.fault == FaultMode::Touch)
+        {
+            const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+            volatile unsigned char* bytesOf = (volatile unsigned char*)sortKeys;
+            for(size_t offset = 0; offset < bytes; offset += page)
+            {
+                bytesOf[offset] = bytesOf[offset];
+            }
+        }
+#endif
+        long long faultNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        if(!options.output.empty())
+        {
+            std::memcpy(sortKeys, inputKeys, bytes);
+        }
+        return faultNs;
+    }
+
+private:
+#ifdef __linux__
+    int sortFlags() const
+    {
+        return options.output.empty() ? MAP_PRIVATE : MAP_SHARED;
+    }
+
+    int sortFd() const
+    {
+        return options.output.empty() ? inputFd : outputFd;
+    }
+
+    void* map(void* address, int protection, int flags, int fd)
+    {
+        if(options.fault == FaultMode::Populate)
+        {
+            flags |= MAP_POPULATE;
+        }
+        void* mapped = mmap(address, bytes, protection, flags, fd, 0);
+        if(mapped == MAP_FAILED)
+        {
+            return nullptr;
+        }
+        if(!options.advice.empty())
+        {
+            madvise(mapped, bytes, adviceFlag());
+        }
+        return mapped;
+    }
+
+    int adviceFlag() const
+    {
+        if(options.advice == "sequential")
+        {
+            return MADV_SEQUENTIAL;
+        }
+        if(options.advice == "random")
+        {
+            return MADV_RANDOM;
+        }
+        if(options.advice == "willneed")
+        {
+            return MADV_WILLNEED;
+        }
+#ifdef MADV_HUGEPAGE
+        if(options.advice == "hugepage")
+        {
+            return MADV_HUGEPAGE;
+        }
+#endif
+        return MADV_NORMAL;
+    }
+#endif
+
+    bool fail(const std::string& what)
+    {
+        failure = what + ": " + std::strerror(errno);
+        return false;
+    }
+
+    void close()
+    {
+#ifdef __linux__
+        if(sortKeys != nullptr)
+        {
+            munmap(sortKeys, bytes);
+        }
+        if(inputKeys != nullptr)
+        {
+            munmap((void*)inputKeys, bytes);
+        }
+        if(outputFd >= 0)
+        {
+            ::close(outputFd);
+        }
+        if(inputFd >= 0)
+        {
+            ::close(inputFd);
+        }
+#endif
+    }
+
+    MappedFileOptions options;
+    std::string failure;
+    int inputFd = -1;
+    int outputFd = -1;
+    long long count = 0;
+    size_t bytes = 0;
+    const T* inputKeys = nullptr;
+    T* sortKeys = nullptr;
+};
+
+#endif
@@ -0,0 +1,563 @@
+#ifndef MERGE_SORT_H
+#define MERGE_SORT_H
+
+#include <algorithm>
+#include <climits>
+#include <vector>
+#include <omp.h>
+
+#include "phaseTimer.h"
+#include "simdSort.h"
+#include "sortRegistry.h"
+#include "tuning.h"
+#include "workStealing.h"
+
+inline void merge2SortedArrays(int a[], int si, int ei)
+{
+    PhaseTimer timer(PHASE_MERGE);
+    int size_output=(ei-si)+1;
+    int* output=new int[size_output];
+
+    int mid=(si+ei)/2;
+    int i=si, j=mid+1, k=0;
+    while(i<=mid && j<=ei)
+    {
+        if(a[i]<=a[j])
+        {
+            output[k]=a[i];
+            i++;
+            k++;
+        }
+        else
+        {
+            output[k]=a[j];
+            j++;
+            k++;
+        }
+
+    }
+    while(i<=mid)
+    {
+        output[k]=a[i];
+        i++;
+        k++;
+    }
+    while(j<=ei)
+    {
+        output[k]=a[j];
+        j++;
+        k++;
+    }
+    int x=0;
+    for(int l=si; l<=ei; l++)
+    {
+        a[l]=output[x];
+        x++;
+    }
+    delete []output;
+}
+
+inline void mergeSort(int a[], int si, int ei)
+{
+    if(si>=ei)
+    {
+        return;
+    }
+    if(ei-si+1<=SIMD_SORT_MAX)
+    {
+        simdSortSmall(a+si, ei-si+1);
+        return;
+    }
+    int mid=(si+ei)/2;
+
+    mergeSort(a, si, mid);
+    mergeSort(a, mid+1, ei);
+
+    merge2SortedArrays(a, si, ei);
+}
+
+/* Merge path (co-rank) partitioning.
+
+For an output rank k of the merge of two sorted runs x and y, coRank returns how
+many of the first k output elements come from x. Cutting the output at equally
+spaced ranks therefore splits one big merge into independent segments of the
+same size, which can be merged by different threads without any synchronization.
+Ties are taken from x first, so the result is the same as the serial merge. */
+inline int coRank(int k, const int x[], int nx, const int y[], int ny)
+{
+    int lo = (k > ny) ? k - ny : 0;
+    int hi = (k < nx) ? k : nx;
+    while(lo < hi)
+    {
+        int i = lo + (hi - lo) / 2;
+        int j = k - i;
+        if(y[j - 1] < x[i])
+        {
+            hi = i;
+        }
+        else
+        {
+            lo = i + 1;
+        }
+    }
+    return lo;
+}
+
+inline void mergeRuns(const int x[], int nx, const int y[], int ny, int output[])
+{
+    PhaseTimer timer(PHASE_MERGE);
+    simdMergeRuns(x, nx, y, ny, output);
+}
+
+// Merges below this size are done by a single task, the split is not worth it
+const int MERGE_PATH_CUTOFF = 100000;
+
+inline void merge2SortedArraysMergePath(int a[], int si, int ei)
+{
+    int size_output=(ei-si)+1;
+    int* output=new int[size_output];
+
+    int mid=(si+ei)/2;
+    const int* x=a+si;
+    const int* y=a+mid+1;
+    int nx=mid-si+1;
+    int ny=ei-mid;
+
+    // One output segment per thread of the team, each merged by its own task
+    int segments=taskTeamSize();
+    forEachTask(segments, [&](int s)
+    {
+        int kBegin=(int)((long long)size_output*s/segments);
+        int kEnd=(int)((long long)size_output*(s+1)/segments);
+        int iBegin=coRank(kBegin, x, nx, y, ny);
+        int iEnd=coRank(kEnd, x, nx, y, ny);
+        int jBegin=kBegin-iBegin;
+        int jEnd=kEnd-iEnd;
+        mergeRuns(x+iBegin, iEnd-iBegin, y+jBegin, jEnd-jBegin, output+kBegin);
+    });
+
+    // The copy back can only start once every segment has read its inputs
+    forEachTask(segments, [&](int s)
+    {
+        int kBegin=(int)((long long)size_output*s/segments);
+        int kEnd=(int)((long long)size_output*(s+1)/segments);
+        std::copy(output+kBegin, output+kEnd, a+si+kBegin);
+    });
+
+    delete []output;
+}
+
+inline void merge2SortedArraysParallel(int a[], int si, int ei)
+{
+    int size_output=(ei-si)+1;
+    if(size_output>=MERGE_PATH_CUTOFF && taskTeamSize()>1)
+    {
+        merge2SortedArraysMergePath(a, si, ei);
+        return;
+    }
+    PhaseTimer timer(PHASE_MERGE);
+
+    int* output=new int[size_output];
+
+    int mid=(si+ei)/2;
+    int i=si, j=mid+1, k=0;
+    while(i<=mid && j<=ei)
+    {
+        if(a[i]<=a[j])
+        {
+            output[k]=a[i];
+            i++;
+            k++;
+        }
+        else
+        {
+            output[k]=a[j];
+            j++;
+            k++;
+        }
+
+    }
+    while(i<=mid)
+    {
+        output[k]=a[i];
+        i++;
+        k++;
+    }
+    while(j<=ei)
+    {
+        output[k]=a[j];
+        j++;
+        k++;
+    }
+    int x=0;
+    for(int l=si; l<=ei; l++)
+    {
+        a[l]=output[x];
+        x++;
+    }
+    delete []output;
+}
+
+// Sub-arrays up to this size are sorted by the task that reaches them (see tuning.h)
+inline int mergeSortTaskCutoff = 5000;
+REGISTER_TUNABLE(mergeSortTaskCutoff, "mergeSortParallel", 256, 262144)
+
+inline void mergeSortParallelHelper(int a[], int si, int ei)
+{
+    if(si>=ei)
+    {
+        return;
+    }
+    if(ei-si+1<=SIMD_SORT_MAX)
+    {
+        simdSortSmall(a+si, ei-si+1);
+        return;
+    }
+    int mid=(si+ei)/2;
+    //using a threshold to limit the creation of small tasks
+    if ((ei - si) > mergeSortTaskCutoff) {
+        forkJoin([&] { mergeSortParallelHelper(a, si, mid); }, [&] { mergeSortParallelHelper(a, mid+1, ei); });
+    } else {
+        mergeSortParallelHelper(a, si, mid);
+        mergeSortParallelHelper(a, mid + 1, ei);
+    }
+    merge2SortedArraysParallel(a, si, ei);
+
+}
+
+inline void mergeSortParallel(int a[], int si, int ei, TaskBackend backend = TaskBackend::OpenMP)
+{
+    runTaskRoot(backend, [&] { mergeSortParallelHelper(a, si, ei); });
+}
+
+/* Bottom-up merge sort with a single scratch buffer.
+
+The recursive versions above allocate a temporary array on every merge and copy
+each merged run back into a. Here the whole sort allocates one scratch buffer of
+n elements, sorts blocks of SIMD_SORT_MAX elements with the in-register network,
+merges runs of width 32, 64, 128, ... and swaps the roles of source and
+destination after every level, so each level reads and writes the data exactly
+once. Only if the last level ends in the scratch buffer is there a final copy. */
+inline void mergeLevelSegment(const int src[], int dst[], int n, long long width, int kBegin, int kEnd)
+{
+    // Merges the output positions [kBegin, kEnd) of one level, which may span several pairs of runs
+    for(long long pairStart=(kBegin/(2*width))*(2*width); pairStart<kEnd; pairStart+=2*width)
+    {
+        int mid=(int)std::min<long long>(pairStart+width, n);
+        int end=(int)std::min<long long>(pairStart+2*width, n);
+        int segBegin=(int)(std::max<long long>(kBegin, pairStart)-pairStart);
+        int segEnd=(int)(std::min(kEnd, end)-pairStart);
+
+        const int* x=src+pairStart;
+        const int* y=src+mid;
+        int nx=mid-pairStart;
+        int ny=end-mid;
+        int iBegin=coRank(segBegin, x, nx, y, ny);
+        int iEnd=coRank(segEnd, x, nx, y, ny);
+        int jBegin=segBegin-iBegin;
+        int jEnd=segEnd-iEnd;
+        mergeRuns(x+iBegin, iEnd-iBegin, y+jBegin, jEnd-jBegin, dst+pairStart+segBegin);
+    }
+}
+
+inline void mergeSortBottomUp(int a[], int n)
+{
+    if(n<2)
+    {
+        return;
+    }
+    int* scratch=new int[n];
+    int* src=a;
+    int* dst=scratch;
+
+    for(long long leaf=0; leaf<n; leaf+=SIMD_SORT_MAX)
+    {
+        simdSortSmall(a+leaf, (int)std::min<long long>(SIMD_SORT_MAX, n-leaf));
+    }
+
+    for(long long width=SIMD_SORT_MAX; width<n; width*=2)
+    {
+        for(long long pairStart=0; pairStart<n; pairStart+=2*width)
+        {
+            int mid=(int)std::min<long long>(pairStart+width, n);
+            int end=(int)std::min<long long>(pairStart+2*width, n);
+            mergeRuns(src+pairStart, mid-pairStart, src+mid, end-mid, dst+pairStart);
+        }
+        std::swap(src, dst);
+    }
+
+    if(src!=a)
+    {
+        std::copy(src, src+n, a);
+    }
+    delete []scratch;
+}
+
+inline void mergeSortBottomUpParallel(int a[], int n)
+{
+    if(n<2)
+    {
+        return;
+    }
+    int* scratch=new int[n];
+
+    /* One parallel region for the whole sort. Every level is split into equal
+    output segments with merge path, one per thread, so the last levels (with
+    only a couple of long runs) keep all threads busy as well. */
+    #pragma omp parallel
+    {
+        int* src=a;
+        int* dst=scratch;
+        int tid=omp_get_thread_num();
+        int nthreads=omp_get_num_threads();
+        int kBegin=(int)((long long)n*tid/nthreads);
+        int kEnd=(int)((long long)n*(tid+1)/nthreads);
+
+        #pragma omp for schedule(static)
+        for(long long leaf=0; leaf<n; leaf+=SIMD_SORT_MAX)
+        {
+            simdSortSmall(a+leaf, (int)std::min<long long>(SIMD_SORT_MAX, n-leaf));
+        }
+
+        for(long long width=SIMD_SORT_MAX; width<n; width*=2)
+        {
+            mergeLevelSegment(src, dst, n, width, kBegin, kEnd);
+            std::swap(src, dst);
+            #pragma omp barrier
+        }
+
+        if(src!=a)
+        {
+            std::copy(src+kBegin, src+kEnd, a+kBegin);
+        }
+    }
+    delete []scratch;
+}
+
+/* Multiway merge sort.
+
+The bottom-up parallel merge sort above still merges pairwise: once every thread
+has sorted its part, the array streams through memory once per level, log2(p) more
+times for p threads, and those top levels are bound by memory bandwidth. Here every
+thread sorts a contiguous chunk and then all p chunks are merged in a single pass:
+- the chunk sort ends in the scratch buffer (mergeSortRunInto), so the multiway merge
+  reads the scratch buffer and writes the final result straight into a;
+- the output is cut at the ranks n * t / p. multiwaySelect finds, for a rank, how
+  many elements of every run come before it (multi-sequence selection), so each
+  thread knows exactly which pieces of the p runs make up its share of the output;
+- each thread merges its pieces with a loser tree: a tournament tree whose inner
+  nodes keep the loser of the match played there, so replacing the winner only
+  replays the log2(p) matches on its own path to the root.
+Ties are taken from the lower chunk first, in the selection and in the tree, so the
+sort is stable. */
+
+// Sorts a[0..n) like mergeSortBottomUp, but leaves the result in out; a is used as scratch
+inline void mergeSortRunInto(int a[], int out[], int n)
+{
+    int levels = 0;
+    for(long long width = SIMD_SORT_MAX; width < n; width *= 2)
+    {
+        levels++;
+    }
+    // The levels alternate between the buffers: start in out when there is an even number of them
+    int* src = levels % 2 == 0 ? out : a;
+    int* dst = levels % 2 == 0 ? a : out;
+    for(long long leaf = 0; leaf < n; leaf += SIMD_SORT_MAX)
+    {
+        int count = (int)std::min<long long>(SIMD_SORT_MAX, n - leaf);
+        if(src != a)
+        {
+            std::copy(a + leaf, a + leaf + count, src + leaf);
+        }
+        simdSortSmall(src + leaf, count);
+    }
+    for(long long width = SIMD_SORT_MAX; width < n; width *= 2)
+    {
+        for(long long pairStart = 0; pairStart < n; pairStart += 2 * width)
+        {
+            int mid = (int)std::min<long long>(pairStart + width, n);
+            int end = (int)std::min<long long>(pairStart + 2 * width, n);
+            mergeRuns(src + pairStart, mid - pairStart, src + mid, end - mid, dst + pairStart);
+        }
+        std::swap(src, dst);
+    }
+}
+
+/* For the k sorted runs data[bounds[j], bounds[j + 1]), finds split[j] such that the
+elements before split[j] in every run are the rank smallest of all runs. The rank-th
+smallest value v is found with a binary search over the key range, counting with
+lower_bound / upper_bound in every run; the elements equal to v that belong before
+the rank are then taken from the lowest runs first. */
+inline void multiwaySelect(const int data[], const int bounds[], int k, int rank, int split[])
+{
+    long long lo = INT_MIN;
+    long long hi = INT_MAX;
+    if(rank >= bounds[k] - bounds[0])
+    {
+        std::copy(bounds + 1, bounds + k + 1, split);
+        return;
+    }
+    // Smallest v with more than rank elements <= v
+    while(lo < hi)
+    {
+        long long mid = lo + (hi - lo) / 2;
+        long long atMost = 0;
+        for(int j = 0; j < k; j++)
+        {
+            atMost += std::upper_bound(data + bounds[j], data + bounds[j + 1], (int)mid) - (data + bounds[j]);
+        }
+        if(atMost > rank)
+        {
+            hi = mid;
+        }
+        else
+        {
+            lo = mid + 1;
+        }
+    }
+    int v = (int)lo;
+
+    long long below = 0;
+    for(int j = 0; j < k; j++)
+    {
+        split[j] = (int)(std::lower_bound(data + bounds[j], data + bounds[j + 1], v) - data);
+        below += split[j] - bounds[j];
+    }
+    long long ties = rank - below;
+    for(int j = 0; j < k && ties > 0; j++)
+    {
+        int equal = (int)(std::upper_bound(data + split[j], data + bounds[j + 1], v) - (data + split[j]));
+        int take = (int)std::min<long long>(ties, equal);
+        split[j] += take;
+        ties -= take;
+    }
+}
+
+class LoserTree
+{
+public:
+    // The runs are [begin[j], end[j]) for j < k
+    LoserTree(const int* const begin[], const int* const end[], int k)
+    {
+        leaves = 1;
+        while(leaves < k)
+        {
+            leaves *= 2;
+        }
+        cur.assign(leaves, nullptr);
+        last.assign(leaves, nullptr);
+        for(int j = 0; j < k; j++)
+        {
+            cur[j] = begin[j];
+            last[j] = end[j];
+        }
+
+        // Play the whole tournament once; every inner node keeps its loser
+        tree.assign(leaves, 0);
+        std::vector<int> winner(2 * leaves);
+        for(int j = 0; j < leaves; j++)
+        {
+            winner[leaves + j] = j;
+        }
+        for(int node = leaves - 1; node >= 1; node--)
+        {
+            int x = winner[2 * node];
+            int y = winner[2 * node + 1];
+            winner[node] = beats(x, y) ? x : y;
+            tree[node] = beats(x, y) ? y : x;
+        }
+        tree[0] = winner[1];
+    }
+
+    // Writes the next count elements of the merge to output
+    void merge(int output[], int count)
+    {
+        for(int i = 0; i < count; i++)
+        {
+            int run = tree[0];
+            output[i] = *cur[run]++;
+            for(int node = (run + leaves) / 2; node >= 1; node /= 2)
+            {
+                if(beats(tree[node], run))
+                {
+                    std::swap(tree[node], run);
+                }
+            }
+            tree[0] = run;
+        }
+    }
+
+private:
+    // Whether run x's head comes before run y's: exhausted runs lose, ties go to the lower run
+    bool beats(int x, int y) const
+    {
+        bool xDone = cur[x] == last[x];
+        bool yDone = cur[y] == last[y];
+        if(xDone || yDone)
+        {
+            return yDone && (!xDone || x < y);
+        }
+        return *cur[x] < *cur[y] || (*cur[x] == *cur[y] && x < y);
+    }
+
+    int leaves;
+    std::vector<const int*> cur;
+    std::vector<const int*> last;
+    std::vector<int> tree;  // tree[0] is the winner, tree[1..leaves) the losers of the inner nodes
+};
+
+inline void mergeSortMultiway(int a[], int n)
+{
+    int maxThreads = omp_get_max_threads();
+    if(n < 2 * SIMD_SORT_MAX * maxThreads)
+    {
+        mergeSortBottomUp(a, n);
+        return;
+    }
+    int* scratch = new int[n];
+    std::vector<int> bounds(maxThreads + 1);
+
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int p = omp_get_num_threads();
+
+        int begin = (int)((long long)n * tid / p);
+        int end = (int)((long long)n * (tid + 1) / p);
+        bounds[tid] = begin;
+        if(tid == p - 1)
+        {
+            bounds[p] = n;
+        }
+        mergeSortRunInto(a + begin, scratch + begin, end - begin);
+        #pragma omp barrier
+
+        // Output share [begin, end) of this thread: the pieces [from[j], to[j]) of every run
+        std::vector<int> from(p);
+        std::vector<int> to(p);
+        multiwaySelect(scratch, bounds.data(), p, begin, from.data());
+        multiwaySelect(scratch, bounds.data(), p, end, to.data());
+
+        PhaseTimer timer(PHASE_MERGE);
+        std::vector<const int*> runBegin(p);
+        std::vector<const int*> runEnd(p);
+        for(int j = 0; j < p; j++)
+        {
+            runBegin[j] = scratch + from[j];
+            runEnd[j] = scratch + to[j];
+        }
+        LoserTree tree(runBegin.data(), runEnd.data(), p);
+        tree.merge(a + begin, end - begin);
+    }
+    delete[] scratch;
+}
+
+REGISTER_SORT(mergeSort, "mergeSort", false, [](int* a, int n) { mergeSort(a, 0, n - 1); })
+REGISTER_SORT(mergeSortParallel, "mergeSort", true, [](int* a, int n) { mergeSortParallel(a, 0, n - 1); })
+REGISTER_SORT(mergeSortParallelStealing, "mergeSort", true,
+              [](int* a, int n) { mergeSortParallel(a, 0, n - 1, TaskBackend::WorkStealing); })
+REGISTER_SORT(mergeSortBottomUp, "mergeSort", false, mergeSortBottomUp)
+REGISTER_SORT(mergeSortBottomUpParallel, "mergeSort", true, mergeSortBottomUpParallel)
+REGISTER_SORT(mergeSortMultiway, "mergeSort", true, mergeSortMultiway)
+
+#endif
@@ -0,0 +1,262 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <cerrno>
+#include <string>
+#include <vector>
+#include <omp.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/* Hardware performance counters around a timed run (the --perf option).
+
+Every thread of the OpenMP team opens its own set of user-space counters with
+perf_event_open once, from inside a parallel region, so the counters follow the
+pool threads that later run the sorts. start() resets and enables all of them,
+stop() disables them, and read() sums them over the threads. The counters are
+opened one by one rather than as a group, so the kernel can multiplex them when
+there are more events than hardware counters; each value is scaled by its
+enabled / running time.
+
+Counting starts and stops from the calling thread while the rest of the team is
+idle, so the totals include the spin-waiting of idle pool threads around serial
+runs. A counter the CPU or kernel does not support reads as unavailable; if not even
+the cycle counter can be opened (no PMU access in a container, or
+perf_event_paranoid too high) the binaries fall back to timings only.
+
+Threads that are not OpenMP threads, like the workers of the work-stealing pool
+(workStealing.h), are not counted. A pool bumps perfUncountedRuns whenever it runs,
+and a run during which that happened reads as unavailable, with a warning on the first
+one, rather than reporting the calling thread's share as the whole team's. */
+enum PerfCounter
+{
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_BRANCH_MISSES,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_DTLB_MISSES,
+    PERF_COUNTER_COUNT
+};
+
+const char* const PERF_COUNTER_NAMES[PERF_COUNTER_COUNT] = {"cycles", "instructions", "branch-misses",
+                                                            "L1D misses", "LLC misses", "dTLB misses"};
+const char* const PERF_COUNTER_COLUMNS[PERF_COUNTER_COUNT] = {"cycles", "instructions", "branch_misses",
+                                                              "l1d_misses", "llc_misses", "dtlb_misses"};
+
+// Incremented by thread pools whose threads the counters do not follow
+inline std::atomic<long long> perfUncountedRuns(0);
+
+struct PerfSample
+{
+    long long value[PERF_COUNTER_COUNT];
+    bool valid[PERF_COUNTER_COUNT];
+};
+
+class PerfCounters
+{
+public:
+    PerfCounters() = default;
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    ~PerfCounters()
+    {
+        close();
+    }
+
+    // Opens the counters on every thread of the team; returns false (see error()) if they are unavailable
+    bool open()
+    {
+#ifdef __linux__
+        int threads = omp_get_max_threads();
+        fds.assign(threads * PERF_COUNTER_COUNT, -1);
+        std::vector<int> errors(threads, 0);
+
+        #pragma omp parallel num_threads(threads)
+        {
+            int t = omp_get_thread_num();
+            for(int c = 0; c < PERF_COUNTER_COUNT; c++)
+            {
+                perf_event_attr attr = counterAttr(static_cast<PerfCounter>(c));
+                int fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+                fds[t * PERF_COUNTER_COUNT + c] = fd;
+                if(fd < 0 && c == PERF_CYCLES)
+                {
+                    errors[t] = errno;
+                }
+            }
+        }
+
+        for(int t = 0; t < threads; t++)
+        {
+            if(errors[t] != 0)
+            {
+                failure = std::string("perf_event_open failed: ") + std::strerror(errors[t]) +
+                          " (check /proc/sys/kernel/perf_event_paranoid)";
+                close();
+                return false;
+            }
+        }
+        return true;
+#else
+        failure = "perf_event_open is only available on Linux";
+        return false;
+#endif
+    }
+
+    bool available() const
+    {
+        return !fds.empty();
+    }
+
+    const std::string& error() const
+    {
+        return failure;
+    }
+
+    void start()
+    {
+        uncountedBefore = perfUncountedRuns.load(std::memory_order_relaxed);
+#ifdef __linux__
+        for(int fd : fds)
+        {
+            if(fd >= 0)
+            {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+#endif
+    }
+
+    void stop()
+    {
+#ifdef __linux__
+        for(int fd : fds)
+        {
+            if(fd >= 0)
+            {
+                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            }
+        }
+#endif
+    }
+
+    // Sum over the threads of every counter, scaled for multiplexing
+    PerfSample read() const
+    {
+        PerfSample sample;
+        for(int c = 0; c < PERF_COUNTER_COUNT; c++)
+        {
+            sample.value[c] = 0;
+            sample.valid[c] = false;
+        }
+        if(perfUncountedRuns.load(std::memory_order_relaxed) != uncountedBefore)
+        {
+            if(available() && !warnedUncounted)
+            {
+                std::cerr << "--perf does not count the work-stealing pool's threads, "
+                             "counters of runs that use it are left empty\n";
+                warnedUncounted = true;
+            }
+            return sample;
+        }
+#ifdef __linux__
+        for(size_t i = 0; i < fds.size(); i++)
+        {
+            if(fds[i] < 0)
+            {
+                continue;
+            }
+            // value, time enabled, time running (PERF_FORMAT_TOTAL_TIME_ENABLED | _RUNNING)
+            unsigned long long data[3];
+            if(::read(fds[i], data, sizeof(data)) != (ssize_t)sizeof(data))
+            {
+                continue;
+            }
+            int c = (int)(i % PERF_COUNTER_COUNT);
+            sample.valid[c] = true;
+            if(data[2] > 0)
+            {
+                sample.value[c] += (long long)((double)data[0] * data[1] / data[2]);
+            }
+        }
+#endif
+        return sample;
+    }
+
+private:
+#ifdef __linux__
+    static perf_event_attr counterAttr(PerfCounter counter)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        const unsigned long long readMiss = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        switch(counter)
+        {
+        case PERF_CYCLES:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case PERF_INSTRUCTIONS:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case PERF_BRANCH_MISSES:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        case PERF_L1D_MISSES:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_L1D | readMiss;
+            break;
+        case PERF_LLC_MISSES:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_LL | readMiss;
+            break;
+        case PERF_DTLB_MISSES:
+        default:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_DTLB | readMiss;
+            break;
+        }
+        return attr;
+    }
+#endif
+
+    void close()
+    {
+#ifdef __linux__
+        for(int fd : fds)
+        {
+            if(fd >= 0)
+            {
+                ::close(fd);
+            }
+        }
+#endif
+        fds.clear();
+    }
+
+    std::vector<int> fds;  // thread * PERF_COUNTER_COUNT + counter, -1 where the counter is not supported
+    std::string failure;
+    long long uncountedBefore = 0;
+    mutable bool warnedUncounted = false;
+};
+
+#endif
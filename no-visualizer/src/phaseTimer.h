@@ -0,0 +1,82 @@
+#ifndef PHASE_TIMER_H
+#define PHASE_TIMER_H
+
+#include <chrono>
+#include <algorithm>
+#include <omp.h>
+
+/* Per-phase time breakdown of the sorting engines.
+
+The engines wrap their partition, merge and leaf-sort work in a PhaseTimer. While
+phaseTimingEnabled is set (the --phases option of the benchmarks), every timer adds
+its duration to the totals of the calling thread; otherwise it costs one predictable
+branch. Timers only wrap serial pieces of work (a partition, one merge, one leaf sort),
+never a region that waits for tasks, so in parallel runs the totals are thread time
+summed over the team and nothing is counted twice. Whatever is left of the wall time
+is recursion, task management and splitting overhead. */
+enum SortPhase
+{
+    PHASE_PARTITION,
+    PHASE_MERGE,
+    PHASE_LEAF,
+    PHASE_COUNT
+};
+
+const char* const PHASE_NAMES[PHASE_COUNT] = {"partition", "merge", "leaf sort"};
+const int PHASE_MAX_THREADS = 256;
+
+struct alignas(64) PhaseTotals
+{
+    long long ns[PHASE_COUNT];
+};
+
+inline bool phaseTimingEnabled = false;
+inline PhaseTotals phaseTotals[PHASE_MAX_THREADS];
+inline thread_local int phaseThreadSlot = -1;  // set by threads that are not OpenMP threads (workStealing.h)
+
+class PhaseTimer
+{
+public:
+    explicit PhaseTimer(SortPhase phase) : phase(phase), active(phaseTimingEnabled)
+    {
+        if(active)
+        {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~PhaseTimer()
+    {
+        if(active)
+        {
+            auto end = std::chrono::steady_clock::now();
+            int thread = (phaseThreadSlot >= 0 ? phaseThreadSlot : omp_get_thread_num()) % PHASE_MAX_THREADS;
+            phaseTotals[thread].ns[phase] += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        }
+    }
+
+private:
+    SortPhase phase;
+    bool active;
+    std::chrono::steady_clock::time_point start;
+};
+
+inline void resetPhaseTimers()
+{
+    for(PhaseTotals& totals : phaseTotals)
+    {
+        std::fill(totals.ns, totals.ns + PHASE_COUNT, 0LL);
+    }
+}
+
+inline long long phaseTotalNs(SortPhase phase)
+{
+    long long total = 0;
+    for(const PhaseTotals& totals : phaseTotals)
+    {
+        total += totals.ns[phase];
+    }
+    return total;
+}
+
+#endif
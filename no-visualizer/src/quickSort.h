@@ -0,0 +1,577 @@
+#ifndef QUICK_SORT_H
+#define QUICK_SORT_H
+
+#include <algorithm>
+#include <vector>
+#include <omp.h>
+
+#include "phaseTimer.h"
+#include "simdSort.h"
+#include "sortRegistry.h"
+#include "tuning.h"
+#include "workStealing.h"
+
+/* This parallel Quick Sort algorithm implements a "divide and conquer" strategy, using OpenMP tasks for parallel execution.
+
+The main idea is:
+1.  Partition Array: 
+
+    In this subroutine, a pivot element is chosen (in this case, the first element of the sub-array),
+    and the array is reordered so that all elements less than or equal to the pivot come before it,
+    and all elements greater than the pivot come after it. This operation defines the pivot's
+    final sorted position.
+
+2.  Recursive Sorting with Parallel Tasks: 
+
+    Quick Sort algorithm then recursively sorts the sub-arrays to the left and right of the pivot.
+    For sub-arrays larger than a defined threshold (quickSortTaskCutoff, 10,000 elements
+    unless tuned, see tuning.h), OpenMP tasks are
+    used to execute these recursive calls in parallel. This allows different parts of the array
+    to be sorted concurrently by available threads.
+    Smaller sub-arrays are sorted sequentially to avoid overhead of task creation.
+    The tasks go through forkJoin, so quickSortParallelEntry can also run them on the
+    work-stealing pool of workStealing.h instead of OpenMP.
+
+3.  Parallel Partition:
+
+    The first levels of the recursion have only one or two sub-arrays, so for sub-arrays
+    larger than PARALLEL_PARTITION_CUTOFF the partition itself is split among the threads
+    (see partitionArrayBlocked). */
+
+inline int partitionArray(int a[], int si, int ei)
+{
+    PhaseTimer timer(PHASE_PARTITION);
+    int count_small=0;
+
+    for(int i=(si+1);i<=ei;i++)
+    {
+        if(a[i]<=a[si])
+        {
+            count_small++;
+        }
+    }
+    int c=si+count_small;
+    int temp=a[c];
+    a[c]=a[si];
+    a[si]=temp;
+
+    int i=si, j=ei;
+
+    while(i<c && j>c)
+    {
+        if(a[i]<= a[c])
+        {
+            i++;
+        }
+        else if(a[j]>a[c])
+        {
+            j--;
+        }
+        else
+        {
+            int temp_1=a[j];
+            a[j]=a[i];
+            a[i]=temp_1;
+
+            i++;
+            j--;
+        }
+    }
+    return c;
+}
+
+inline void quickSort(int a[], int si, int ei)
+{
+    if(si>=ei)
+    {
+        return;
+    }
+    if(ei-si+1<=SIMD_SORT_MAX)
+    {
+        simdSortSmall(a+si, ei-si+1);
+        return;
+    }
+
+    int c=partitionArray(a, si, ei);
+    quickSort(a, si, c-1);
+    quickSort(a, c+1, ei);
+
+}
+
+inline int partitionArrayParallel(int a[], int si, int ei)
+{
+    PhaseTimer timer(PHASE_PARTITION);
+    int count_small=0;
+
+    for(int i=(si+1);i<=ei;i++)
+    {
+        if(a[i]<=a[si])
+        {
+            count_small++;
+        }
+    }
+    int c=si+count_small;
+    int temp=a[c];
+    a[c]=a[si];
+    a[si]=temp;
+
+    int i=si, j=ei;
+
+    while(i<c && j>c)
+    {
+        if(a[i]<= a[c])
+        {
+            i++;
+        }
+        else if(a[j]>a[c])
+        {
+            j--;
+        }
+        else
+        {
+            int temp_1=a[j];
+            a[j]=a[i];
+            a[i]=temp_1;
+
+            i++;
+            j--;
+        }
+    }
+    return c;
+}
+
+/* Block-based parallel partition.
+
+For large sub-arrays the partition itself is split among the threads of the team:
+every task claims fixed-size blocks from the left end and from the right end of the
+range and "neutralizes" them, swapping elements greater than the pivot from its left
+block with elements less than or equal to the pivot from its right block. When one of
+its blocks is done the task claims a new one from the same side. Once fewer than one
+block of unclaimed elements is left, the tasks stop, leaving at most one unfinished
+block each.
+
+The cleanup phase then swaps the unfinished left blocks next to the unclaimed middle
+(and likewise on the right), so that everything outside that dirty window is already
+in place, and partitions the window serially. */
+const int PARTITION_BLOCK = 4096;
+const int PARALLEL_PARTITION_CUTOFF = 1 << 17;
+
+struct PartitionBlocks
+{
+    int leftEnd;     // next unclaimed position on the left
+    int rightStart;  // one past the next unclaimed position on the right
+};
+
+inline bool claimLeftBlock(PartitionBlocks& blocks, int& begin)
+{
+    bool claimed=false;
+    #pragma omp critical(partitionClaim)
+    {
+        if(blocks.rightStart-blocks.leftEnd>=PARTITION_BLOCK)
+        {
+            begin=blocks.leftEnd;
+            blocks.leftEnd+=PARTITION_BLOCK;
+            claimed=true;
+        }
+    }
+    return claimed;
+}
+
+inline bool claimRightBlock(PartitionBlocks& blocks, int& begin)
+{
+    bool claimed=false;
+    #pragma omp critical(partitionClaim)
+    {
+        if(blocks.rightStart-blocks.leftEnd>=PARTITION_BLOCK)
+        {
+            blocks.rightStart-=PARTITION_BLOCK;
+            begin=blocks.rightStart;
+            claimed=true;
+        }
+    }
+    return claimed;
+}
+
+// Partitions a[lo..hi) serially, returns the first position holding an element > pivot
+inline int partitionRange(int a[], int lo, int hi, int pivot)
+{
+    int i=lo, j=hi-1;
+    while(true)
+    {
+        while(i<=j && a[i]<=pivot)
+        {
+            i++;
+        }
+        while(i<=j && a[j]>pivot)
+        {
+            j--;
+        }
+        if(i>=j)
+        {
+            return i;
+        }
+        int temp=a[i];
+        a[i]=a[j];
+        a[j]=temp;
+        i++;
+        j--;
+    }
+}
+
+inline void neutralizeBlocks(int a[], int pivot, PartitionBlocks& blocks, int& unfinishedLeft, int& unfinishedRight)
+{
+    PhaseTimer timer(PHASE_PARTITION);
+    unfinishedLeft=-1;
+    unfinishedRight=-1;
+
+    int left, right;
+    if(!claimLeftBlock(blocks, left))
+    {
+        return;
+    }
+    if(!claimRightBlock(blocks, right))
+    {
+        unfinishedLeft=left;
+        return;
+    }
+
+    int i=left, j=right;
+    while(true)
+    {
+        while(i<left+PARTITION_BLOCK && a[i]<=pivot)
+        {
+            i++;
+        }
+        while(j<right+PARTITION_BLOCK && a[j]>pivot)
+        {
+            j++;
+        }
+        if(i==left+PARTITION_BLOCK)
+        {
+            if(!claimLeftBlock(blocks, left))
+            {
+                if(j<right+PARTITION_BLOCK)
+                {
+                    unfinishedRight=right;
+                }
+                return;
+            }
+            i=left;
+            continue;
+        }
+        if(j==right+PARTITION_BLOCK)
+        {
+            if(!claimRightBlock(blocks, right))
+            {
+                unfinishedLeft=left;
+                return;
+            }
+            j=right;
+            continue;
+        }
+        int temp=a[i];
+        a[i]=a[j];
+        a[j]=temp;
+        i++;
+        j++;
+    }
+}
+
+// Moves the listed blocks into the slots [firstSlot, firstSlot + count * PARTITION_BLOCK)
+inline void gatherBlocks(int a[], std::vector<int>& blocks, int firstSlot)
+{
+    std::sort(blocks.begin(), blocks.end());
+    int slotsEnd=firstSlot+(int)blocks.size()*PARTITION_BLOCK;
+
+    // Blocks already inside the target window stay there, the others take the free slots
+    std::vector<int> freeSlots;
+    for(int slot=firstSlot; slot<slotsEnd; slot+=PARTITION_BLOCK)
+    {
+        if(!std::binary_search(blocks.begin(), blocks.end(), slot))
+        {
+            freeSlots.push_back(slot);
+        }
+    }
+    int next=0;
+    for(int block : blocks)
+    {
+        if(block<firstSlot || block>=slotsEnd)
+        {
+            std::swap_ranges(a+block, a+block+PARTITION_BLOCK, a+freeSlots[next]);
+            next++;
+        }
+    }
+}
+
+inline int partitionArrayBlocked(int a[], int si, int ei)
+{
+    int pivot=a[si];
+    int lo=si+1, hi=ei+1;
+
+    PartitionBlocks blocks;
+    blocks.leftEnd=lo;
+    blocks.rightStart=hi;
+
+    int tasks=taskTeamSize();
+    std::vector<int> unfinishedLeft(tasks), unfinishedRight(tasks);
+    forEachTask(tasks, [&](int t) { neutralizeBlocks(a, pivot, blocks, unfinishedLeft[t], unfinishedRight[t]); });
+
+    // The cleanup runs after the taskwait, so it can be timed without counting the tasks twice
+    PhaseTimer timer(PHASE_PARTITION);
+    std::vector<int> dirtyLeft, dirtyRight;
+    for(int t=0; t<tasks; t++)
+    {
+        if(unfinishedLeft[t]>=0)
+        {
+            dirtyLeft.push_back(unfinishedLeft[t]);
+        }
+        if(unfinishedRight[t]>=0)
+        {
+            dirtyRight.push_back(unfinishedRight[t]);
+        }
+    }
+
+    int windowBegin=blocks.leftEnd-(int)dirtyLeft.size()*PARTITION_BLOCK;
+    int windowEnd=blocks.rightStart+(int)dirtyRight.size()*PARTITION_BLOCK;
+    gatherBlocks(a, dirtyLeft, windowBegin);
+    gatherBlocks(a, dirtyRight, blocks.rightStart);
+
+    int split=partitionRange(a, windowBegin, windowEnd, pivot);
+
+    // Same contract as partitionArray: the pivot ends at c, with a[si..c-1] <= a[c] < a[c+1..ei]
+    int c=split-1;
+    a[si]=a[c];
+    a[c]=pivot;
+    return c;
+}
+
+inline int quickSortTaskCutoff = 10000;
+REGISTER_TUNABLE(quickSortTaskCutoff, "quickSortParallel", 256, 262144)
+
+inline void quickSortParallel(int a[], int si, int ei)
+{
+    if (si >= ei)
+        return;
+    if (ei - si + 1 <= SIMD_SORT_MAX) {
+        simdSortSmall(a + si, ei - si + 1);
+        return;
+    }
+
+    int c;
+    if (ei - si + 1 >= PARALLEL_PARTITION_CUTOFF && taskTeamSize() > 1)
+        c = partitionArrayBlocked(a, si, ei);
+    else
+        c = partitionArrayParallel(a, si, ei);
+
+    // Definir limite mínimo de tamanho para evitar overhead com tarefas pequenas
+    int size = ei - si;
+    if (size > quickSortTaskCutoff) {
+        forkJoin([&] { quickSortParallel(a, si, c - 1); }, [&] { quickSortParallel(a, c + 1, ei); });
+    } else {
+        quickSortParallel(a, si, c - 1);
+        quickSortParallel(a, c + 1, ei);
+    }
+}
+
+inline void quickSortParallelEntry(int a[], int si, int ei, TaskBackend backend = TaskBackend::OpenMP)
+{
+    runTaskRoot(backend, [&] { quickSortParallel(a, si, ei); });
+}
+
+/* Introspective quick sort ("intro" mode of this benchmark).
+
+partitionArray always takes a[si] as the pivot, which makes sorted and reverse-sorted
+inputs cost O(n^2) time and O(n) recursion depth. Intro sort keeps the same partition
+but:
+- moves a better pivot to a[si] first: the median of three samples for small ranges,
+  and Tukey's ninther (median of three medians of three) for larger ones;
+- recurses only into the smaller side and loops on the larger one, so the stack depth
+  is O(log n);
+- falls back to heap sort on a range once the depth limit (2 * log2(n)) is used up,
+  which bounds the worst case (e.g. all-equal keys) to O(n log n);
+- finishes ranges of at most insertionSortCutoff elements with insertion sort.
+Both that size and the task cutoff of the parallel version are tunable (tuning.h). */
+inline int insertionSortCutoff = 16;
+REGISTER_TUNABLE(insertionSortCutoff, "introSort", 4, 64)
+inline int introSortTaskCutoff = 10000;
+REGISTER_TUNABLE(introSortTaskCutoff, "introSortParallel", 256, 262144)
+const int NINTHER_CUTOFF = 128;
+
+inline int medianOfThree(int a[], int i, int j, int k)
+{
+    if(a[i]<a[j])
+    {
+        if(a[j]<a[k]) return j;
+        return (a[i]<a[k]) ? k : i;
+    }
+    if(a[i]<a[k]) return i;
+    return (a[j]<a[k]) ? k : j;
+}
+
+inline int choosePivot(int a[], int si, int ei)
+{
+    int size=ei-si+1;
+    int mid=si+size/2;
+    if(size<NINTHER_CUTOFF)
+    {
+        return medianOfThree(a, si, mid, ei);
+    }
+    int step=size/8;
+    int first=medianOfThree(a, si, si+step, si+2*step);
+    int second=medianOfThree(a, mid-step, mid, mid+step);
+    int third=medianOfThree(a, ei-2*step, ei-step, ei);
+    return medianOfThree(a, first, second, third);
+}
+
+inline void insertionSort(int a[], int si, int ei)
+{
+    PhaseTimer timer(PHASE_LEAF);
+    for(int i=si+1; i<=ei; i++)
+    {
+        int value=a[i];
+        int j=i-1;
+        while(j>=si && a[j]>value)
+        {
+            a[j+1]=a[j];
+            j--;
+        }
+        a[j+1]=value;
+    }
+}
+
+inline void siftDown(int a[], int si, int root, int size)
+{
+    int value=a[si+root];
+    int child=2*root+1;
+    while(child<size)
+    {
+        if(child+1<size && a[si+child]<a[si+child+1])
+        {
+            child++;
+        }
+        if(a[si+child]<=value)
+        {
+            break;
+        }
+        a[si+root]=a[si+child];
+        root=child;
+        child=2*root+1;
+    }
+    a[si+root]=value;
+}
+
+inline void heapSortRange(int a[], int si, int ei)
+{
+    PhaseTimer timer(PHASE_LEAF);
+    int size=ei-si+1;
+    for(int root=size/2-1; root>=0; root--)
+    {
+        siftDown(a, si, root, size);
+    }
+    for(int last=size-1; last>0; last--)
+    {
+        int temp=a[si];
+        a[si]=a[si+last];
+        a[si+last]=temp;
+        siftDown(a, si, 0, last);
+    }
+}
+
+inline int introDepthLimit(int size)
+{
+    int depth=0;
+    while(size>1)
+    {
+        size>>=1;
+        depth+=2;
+    }
+    return depth;
+}
+
+inline int partitionWithPivot(int a[], int si, int ei)
+{
+    int p=choosePivot(a, si, ei);
+    int temp=a[si];
+    a[si]=a[p];
+    a[p]=temp;
+    return partitionArray(a, si, ei);
+}
+
+inline void introSortRec(int a[], int si, int ei, int depthLimit)
+{
+    while(ei-si+1>insertionSortCutoff)
+    {
+        if(depthLimit==0)
+        {
+            heapSortRange(a, si, ei);
+            return;
+        }
+        depthLimit--;
+
+        int c=partitionWithPivot(a, si, ei);
+        if(c-si<ei-c)
+        {
+            introSortRec(a, si, c-1, depthLimit);
+            si=c+1;
+        }
+        else
+        {
+            introSortRec(a, c+1, ei, depthLimit);
+            ei=c-1;
+        }
+    }
+    insertionSort(a, si, ei);
+}
+
+inline void introSort(int a[], int si, int ei)
+{
+    if(si>=ei)
+    {
+        return;
+    }
+    introSortRec(a, si, ei, introDepthLimit(ei-si+1));
+}
+
+inline void introSortParallelRec(int a[], int si, int ei, int depthLimit)
+{
+    int size=ei-si+1;
+    if(size<=introSortTaskCutoff || depthLimit==0)
+    {
+        introSortRec(a, si, ei, depthLimit);
+        return;
+    }
+
+    int p=choosePivot(a, si, ei);
+    int temp=a[si];
+    a[si]=a[p];
+    a[p]=temp;
+
+    int c;
+    if(size>=PARALLEL_PARTITION_CUTOFF && taskTeamSize()>1)
+        c=partitionArrayBlocked(a, si, ei);
+    else
+        c=partitionArray(a, si, ei);
+
+    forkJoin([&] { introSortParallelRec(a, si, c-1, depthLimit-1); },
+             [&] { introSortParallelRec(a, c+1, ei, depthLimit-1); });
+}
+
+inline void introSortParallelEntry(int a[], int si, int ei, TaskBackend backend = TaskBackend::OpenMP)
+{
+    if(si>=ei)
+    {
+        return;
+    }
+    runTaskRoot(backend, [&] { introSortParallelRec(a, si, ei, introDepthLimit(ei-si+1)); });
+}
+
+REGISTER_SORT(quickSort, "quickSort", false, [](int* a, int n) { quickSort(a, 0, n - 1); })
+REGISTER_SORT(quickSortParallel, "quickSort", true, [](int* a, int n) { quickSortParallelEntry(a, 0, n - 1); })
+REGISTER_SORT(quickSortParallelStealing, "quickSort", true,
+              [](int* a, int n) { quickSortParallelEntry(a, 0, n - 1, TaskBackend::WorkStealing); })
+REGISTER_SORT(introSort, "quickSort", false, [](int* a, int n) { introSort(a, 0, n - 1); })
+REGISTER_SORT(introSortParallel, "quickSort", true, [](int* a, int n) { introSortParallelEntry(a, 0, n - 1); })
+REGISTER_SORT(introSortParallelStealing, "quickSort", true,
+              [](int* a, int n) { introSortParallelEntry(a, 0, n - 1, TaskBackend::WorkStealing); })
+
+#endif
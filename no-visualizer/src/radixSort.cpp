@@ -0,0 +1,36 @@
+#include <iostream>
+#include <cstdlib>
+#include <ctime>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <omp.h>
+
+#include "radixSort.h"
+#include "benchHarness.h"
+
+int main(int argc, char* argv[]) {
+    BenchArgs args;
+    if (argc < 2 || !parseBenchArgs(argc, argv, 2, args)) {
+        std::cerr << "Usage: " << argv[0] << " <array_size> " << DISTRIBUTION_USAGE << " [--phases] [--perf] " << MAPPED_FILE_USAGE << "\n";
+        return 1;
+    }
+
+    int n = std::atoi(argv[1]);
+
+    BenchData<int> data(args, n);
+    if (!data.valid()) {
+        return 1;
+    }
+    n = data.size();
+    int* arr = data.arr;
+
+    BenchReport report(args, data);
+    report.run("Radix Sort", arr, [&] { radixSort(arr, n); });
+    report.run("Radix Sort Parallel", arr, [&] { radixSortParallel(arr, n); });
+    report.print();
+
+    return report.allVerified() ? 0 : 1;
+}
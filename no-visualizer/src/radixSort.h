@@ -0,0 +1,204 @@
+#ifndef RADIX_SORT_H
+#define RADIX_SORT_H
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <omp.h>
+
+#include "sortRegistry.h"
+
+/* LSD radix sort for 32-bit integer keys.
+
+The other engines compare keys, but the benchmark keys are bounded 32-bit integers,
+so they can be sorted digit by digit instead: four stable counting-sort passes over
+8-bit digits, from the least to the most significant one. Each pass builds a
+histogram of the digit, turns it into bucket offsets with a prefix sum and scatters
+the keys into a second buffer; the two buffers swap roles after every pass.
+
+Keys are compared as unsigned numbers with the sign bit flipped, so negative values
+sort before positive ones. A pass is skipped when every key has the same digit in it,
+which removes the top pass (or two) for the 0..1,000,000 range used by the benchmark.
+
+The parallel version splits the array into one contiguous chunk per thread. Every
+thread counts its own chunk into a private histogram, the per-thread histograms are
+prefix-summed in (digit, thread) order, which keeps the sort stable, and every thread
+scatters its chunk to its own offsets. The scatter goes through small per-thread
+"software write-combining" buffers of one cache line per bucket, so each thread
+writes whole cache lines to 256 streams instead of single ints to random places. */
+const int RADIX_BITS = 8;
+const int RADIX_BUCKETS = 1 << RADIX_BITS;
+const int RADIX_PASSES = 32 / RADIX_BITS;
+const int WC_LINE_BYTES = 64;  // size of a write-combining buffer, one cache line
+
+inline unsigned radixKey(int value)
+{
+    return (unsigned)value ^ 0x80000000u;
+}
+
+inline int radixDigit(int value, int pass)
+{
+    return (radixKey(value) >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1);
+}
+
+/* The passes are written for any element type and digit function, so other 32-bit
+keys can reuse them: recordSort.h sorts (key, index) pairs packed into 64-bit words by
+the digits of their upper half. digit(value, pass) returns the pass-th RADIX_BITS
+digit, pass 0 being the least significant one. */
+template<typename T, typename Digit>
+inline void radixSortBy(T a[], int n, Digit digit)
+{
+    if(n < 2)
+    {
+        return;
+    }
+    T* buffer = new T[n];
+
+    // One pass over the keys counts all the digits at once
+    std::vector<int> counts(RADIX_PASSES * RADIX_BUCKETS, 0);
+    for(int i = 0; i < n; i++)
+    {
+        for(int pass = 0; pass < RADIX_PASSES; pass++)
+        {
+            counts[pass * RADIX_BUCKETS + digit(a[i], pass)]++;
+        }
+    }
+
+    T* src = a;
+    T* dst = buffer;
+    for(int pass = 0; pass < RADIX_PASSES; pass++)
+    {
+        int* count = &counts[pass * RADIX_BUCKETS];
+        if(count[digit(src[0], pass)] == n)
+        {
+            continue;
+        }
+
+        int offset[RADIX_BUCKETS];
+        int sum = 0;
+        for(int d = 0; d < RADIX_BUCKETS; d++)
+        {
+            offset[d] = sum;
+            sum += count[d];
+        }
+        for(int i = 0; i < n; i++)
+        {
+            dst[offset[digit(src[i], pass)]++] = src[i];
+        }
+        std::swap(src, dst);
+    }
+
+    if(src != a)
+    {
+        std::copy(src, src + n, a);
+    }
+    delete[] buffer;
+}
+
+template<typename T, typename Digit>
+inline void radixSortByParallel(T a[], int n, Digit digit)
+{
+    if(n < 2)
+    {
+        return;
+    }
+    constexpr int line = WC_LINE_BYTES / (int)sizeof(T);  // elements per write-combining buffer
+    T* buffer = new T[n];
+    int maxThreads = omp_get_max_threads();
+    std::vector<int> histograms(maxThreads * RADIX_BUCKETS);
+    bool skipPass = false;
+
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        int begin = (int)((long long)n * tid / nthreads);
+        int end = (int)((long long)n * (tid + 1) / nthreads);
+        int* hist = &histograms[tid * RADIX_BUCKETS];
+
+        alignas(64) T combine[RADIX_BUCKETS][line];
+        int fill[RADIX_BUCKETS];
+        int offset[RADIX_BUCKETS];
+
+        T* src = a;
+        T* dst = buffer;
+        for(int pass = 0; pass < RADIX_PASSES; pass++)
+        {
+            std::fill(hist, hist + RADIX_BUCKETS, 0);
+            for(int i = begin; i < end; i++)
+            {
+                hist[digit(src[i], pass)]++;
+            }
+            #pragma omp barrier
+
+            // Prefix sum over (digit, thread), the histograms become each thread's start offsets
+            #pragma omp single
+            {
+                int sum = 0;
+                int largest = 0;
+                for(int d = 0; d < RADIX_BUCKETS; d++)
+                {
+                    int bucket = 0;
+                    for(int t = 0; t < nthreads; t++)
+                    {
+                        int c = histograms[t * RADIX_BUCKETS + d];
+                        histograms[t * RADIX_BUCKETS + d] = sum;
+                        sum += c;
+                        bucket += c;
+                    }
+                    largest = std::max(largest, bucket);
+                }
+                skipPass = (largest == n);
+            }
+            // The implicit barrier of single publishes the offsets and skipPass
+
+            if(skipPass)
+            {
+                continue;
+            }
+
+            std::copy(hist, hist + RADIX_BUCKETS, offset);
+            std::fill(fill, fill + RADIX_BUCKETS, 0);
+            for(int i = begin; i < end; i++)
+            {
+                T value = src[i];
+                int d = digit(value, pass);
+                combine[d][fill[d]++] = value;
+                if(fill[d] == line)
+                {
+                    std::memcpy(dst + offset[d], combine[d], line * sizeof(T));
+                    offset[d] += line;
+                    fill[d] = 0;
+                }
+            }
+            for(int d = 0; d < RADIX_BUCKETS; d++)
+            {
+                std::memcpy(dst + offset[d], combine[d], fill[d] * sizeof(T));
+            }
+            std::swap(src, dst);
+            #pragma omp barrier
+        }
+
+        // Every thread swapped the same way, so src is the same buffer on all of them
+        if(src != a)
+        {
+            std::copy(src + begin, src + end, a + begin);
+        }
+    }
+    delete[] buffer;
+}
+
+inline void radixSort(int a[], int n)
+{
+    radixSortBy(a, n, radixDigit);
+}
+
+inline void radixSortParallel(int a[], int n)
+{
+    radixSortByParallel(a, n, radixDigit);
+}
+
+REGISTER_SORT(radixSort, "radixSort", false, radixSort)
+REGISTER_SORT(radixSortParallel, "radixSort", true, radixSortParallel)
+
+#endif
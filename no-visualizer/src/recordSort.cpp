@@ -0,0 +1,140 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <omp.h>
+
+#include "recordSort.h"
+#include "sortLibrary.h"
+#include "benchHarness.h"
+
+/* Record-moving against indirect sorting, for records of several sizes.
+
+Usage: recordSort <array_size> <record_bytes,...> [options]
+
+record_bytes is a list of record sizes among 16, 32, 64, 128 and 256. For each size the
+input is n records whose keys come from the chosen distribution and whose payloads are
+derived from their position, and every engine runs serially and in parallel:
+- Record Quick Sort and Record Merge Sort move the whole records (sortLibrary.h);
+- Indirect Record Sort sorts (key, index) words and gathers the records once;
+- Key Payload Sort does the same on a key array and a separate payload array;
+- Argsort only computes the permutation.
+Every result is turned back into an array of records outside the timed region and
+verified, so a payload that got separated from its key fails the run. */
+
+template<int Bytes>
+bool runRecords(int n, const BenchArgs& args) {
+    typedef Record<Bytes> R;
+    const size_t payloadBytes = sizeof(R) - sizeof(int);
+
+    R* input = new R[n];
+    R* arr = new R[n];
+    R* out = new R[n];
+    int* keys = new int[n];
+    unsigned char* payloads = new unsigned char[(size_t)n * payloadBytes];
+    unsigned char* sortedPayloads = new unsigned char[(size_t)n * payloadBytes];
+    uint32_t* perm = new uint32_t[n];
+
+    // Keys from the requested distribution; payload bytes from the position of the record
+    fillDistribution(keys, n, args.input);
+    for (int i = 0; i < n; i++) {
+        input[i].key = keys[i];
+        uint64_t tag = checksumMix((uint64_t)i + 1);
+        for (size_t b = 0; b < payloadBytes; b++) {
+            input[i].payload[b] = (unsigned char)(tag >> (8 * (b % 8)));
+        }
+    }
+
+    auto copyOut = [&] { std::copy(out, out + n, arr); };
+    auto split = [&] {
+        for (int i = 0; i < n; i++) {
+            keys[i] = arr[i].key;
+            std::memcpy(payloads + (size_t)i * payloadBytes, arr[i].payload, payloadBytes);
+        }
+    };
+    auto join = [&] {
+        for (int i = 0; i < n; i++) {
+            arr[i].key = keys[i];
+            std::memcpy(arr[i].payload, sortedPayloads + (size_t)i * payloadBytes, payloadBytes);
+        }
+    };
+    auto applyPerm = [&] {
+        for (int i = 0; i < n; i++) {
+            arr[i] = input[perm[i]];
+        }
+    };
+    auto nothing = [] {};
+
+    BenchReport report(args, input, n);
+    report.run("Record Quick Sort", arr, [&] { sortlib::quickSort(arr, arr + n); });
+    report.run("Record Quick Sort Parallel", arr, [&] { sortlib::quickSortParallel(arr, arr + n); });
+    report.run("Record Merge Sort", arr, [&] { sortlib::mergeSort(arr, arr + n); });
+    report.run("Record Merge Sort Parallel", arr, [&] { sortlib::mergeSortParallel(arr, arr + n); });
+    report.run("Indirect Record Sort", arr, nothing, [&] { sortRecordsIndirect(arr, out, n); }, copyOut);
+    report.run("Indirect Record Sort Parallel", arr, nothing, [&] { sortRecordsIndirectParallel(arr, out, n); }, copyOut);
+    report.run("Key Payload Sort", arr, split, [&] { sortKeyPayload(keys, payloads, sortedPayloads, payloadBytes, n); }, join);
+    report.run("Key Payload Sort Parallel", arr, split,
+               [&] { sortKeyPayloadParallel(keys, payloads, sortedPayloads, payloadBytes, n); }, join);
+    report.run("Argsort", arr, split, [&] { argsort(keys, n, perm); }, applyPerm);
+    report.run("Argsort Parallel", arr, split, [&] { argsortParallel(keys, n, perm); }, applyPerm);
+
+    std::cout << "Records of " << Bytes << " bytes:\n";
+    report.print();
+
+    delete[] input;
+    delete[] arr;
+    delete[] out;
+    delete[] keys;
+    delete[] payloads;
+    delete[] sortedPayloads;
+    delete[] perm;
+
+    return report.allVerified();
+}
+
+int main(int argc, char* argv[]) {
+    BenchArgs args;
+    if (argc < 3 || !parseBenchArgs(argc, argv, 3, args)) {
+        std::cerr << "Usage: " << argv[0] << " <array_size> <record_bytes,...> " << DISTRIBUTION_USAGE
+                  << " [--phases] [--perf]\n"
+                  << "record_bytes: comma-separated sizes among 16, 32, 64, 128 and 256\n";
+        return 1;
+    }
+
+    if (!args.file.input.empty()) {
+        std::cerr << "recordSort generates its records, --input is not supported\n";
+        return 1;
+    }
+
+    int n = std::atoi(argv[1]);
+
+    std::vector<int> sizes;
+    std::stringstream list(argv[2]);
+    std::string item;
+    while (std::getline(list, item, ',')) {
+        int bytes = std::atoi(item.c_str());
+        if (bytes != 16 && bytes != 32 && bytes != 64 && bytes != 128 && bytes != 256) {
+            std::cerr << "Unsupported record size " << item << ", expected 16, 32, 64, 128 or 256\n";
+            return 1;
+        }
+        sizes.push_back(bytes);
+    }
+
+    bool verified = true;
+    for (int bytes : sizes) {
+        switch (bytes) {
+        case 16: verified &= runRecords<16>(n, args); break;
+        case 32: verified &= runRecords<32>(n, args); break;
+        case 64: verified &= runRecords<64>(n, args); break;
+        case 128: verified &= runRecords<128>(n, args); break;
+        default: verified &= runRecords<256>(n, args); break;
+        }
+    }
+
+    return verified ? 0 : 1;
+}
@@ -0,0 +1,212 @@
+#ifndef RECORD_SORT_H
+#define RECORD_SORT_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <omp.h>
+
+#include "radixSort.h"
+
+/* Sorting records by an integer key without moving the records.
+
+A record of 64 to 256 bytes keyed by one int costs a full record copy at every swap of
+a partition and at every move of a merge, O(n log n) record moves in total, while only
+the keys take part in the comparisons. The engines below move the keys instead:
+
+- every key is packed with the position of its record into one 64-bit word, the key
+  (sign bit flipped, so the words compare like the keys) in the upper half and the
+  index in the lower half. Sorting the words sorts the keys and carries the
+  permutation along, and since the indices are distinct, equal keys keep the order of
+  their records: the result is stable whatever the sort.
+- the words are sorted with the radix passes of radixSort.h over the key half only.
+  LSD radix sort is stable and the words start in index order, so the index half
+  never needs a pass of its own.
+- the payloads are then permuted once, by a gather that copies record perm[i] to
+  position i. The reads are random, so the gather prefetches the records a few
+  iterations ahead; the parallel version splits the output positions between the
+  threads.
+
+The interfaces:
+- argsort / argsortParallel only return the permutation, for callers that keep the
+  records where they are;
+- sortKeyPayload / sortKeyPayloadParallel take a struct-of-arrays layout, a key array
+  sorted in place and a payload array gathered into a second one;
+- sortRecordsIndirect / sortRecordsIndirectParallel take an array of Record<Bytes>
+  and gather the whole records into a second array.
+
+Indices are 32-bit, so at most 2^32 records. */
+const int GATHER_PREFETCH = 8;  // records prefetched ahead by the gather
+
+// A record of Bytes bytes: the key and an opaque payload, ordered by the key only
+template<int Bytes>
+struct Record
+{
+    int key;
+    unsigned char payload[Bytes - sizeof(int)];
+};
+
+template<int Bytes>
+inline bool operator<(const Record<Bytes>& a, const Record<Bytes>& b)
+{
+    return a.key < b.key;
+}
+
+inline uint64_t packKeyIndex(int key, uint32_t index)
+{
+    return ((uint64_t)radixKey(key) << 32) | index;
+}
+
+inline int packedKey(uint64_t word)
+{
+    return (int)((uint32_t)(word >> 32) ^ 0x80000000u);
+}
+
+inline uint32_t packedIndex(uint64_t word)
+{
+    return (uint32_t)word;
+}
+
+// Digits of the key half only; the radix passes never look at the index
+inline int packedDigit(uint64_t word, int pass)
+{
+    return (int)(word >> (32 + pass * RADIX_BITS)) & (RADIX_BUCKETS - 1);
+}
+
+inline void sortPacked(const int keys[], int n, uint64_t packed[])
+{
+    for(int i = 0; i < n; i++)
+    {
+        packed[i] = packKeyIndex(keys[i], (uint32_t)i);
+    }
+    radixSortBy(packed, n, packedDigit);
+}
+
+inline void sortPackedParallel(const int keys[], int n, uint64_t packed[])
+{
+    #pragma omp parallel for schedule(static)
+    for(int i = 0; i < n; i++)
+    {
+        packed[i] = packKeyIndex(keys[i], (uint32_t)i);
+    }
+    radixSortByParallel(packed, n, packedDigit);
+}
+
+// Copies record packedIndex(packed[i]) of src to position i of dst, for i in [begin, end)
+inline void gatherRange(const unsigned char* src, unsigned char* dst, size_t bytes,
+                        const uint64_t packed[], int begin, int end)
+{
+    for(int i = begin; i < end; i++)
+    {
+        if(i + GATHER_PREFETCH < end)
+        {
+            const unsigned char* ahead = src + (size_t)packedIndex(packed[i + GATHER_PREFETCH]) * bytes;
+            for(size_t line = 0; line < bytes; line += 64)
+            {
+                __builtin_prefetch(ahead + line);
+            }
+        }
+        std::memcpy(dst + (size_t)i * bytes, src + (size_t)packedIndex(packed[i]) * bytes, bytes);
+    }
+}
+
+inline void gatherPayloads(const unsigned char* src, unsigned char* dst, size_t bytes, const uint64_t packed[], int n)
+{
+    gatherRange(src, dst, bytes, packed, 0, n);
+}
+
+inline void gatherPayloadsParallel(const unsigned char* src, unsigned char* dst, size_t bytes,
+                                   const uint64_t packed[], int n)
+{
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        int begin = (int)((long long)n * tid / nthreads);
+        int end = (int)((long long)n * (tid + 1) / nthreads);
+        gatherRange(src, dst, bytes, packed, begin, end);
+    }
+}
+
+// perm[i] = index of the i-th smallest key; ties keep their index order
+inline void argsort(const int keys[], int n, uint32_t perm[])
+{
+    uint64_t* packed = new uint64_t[n];
+    sortPacked(keys, n, packed);
+    for(int i = 0; i < n; i++)
+    {
+        perm[i] = packedIndex(packed[i]);
+    }
+    delete[] packed;
+}
+
+inline void argsortParallel(const int keys[], int n, uint32_t perm[])
+{
+    uint64_t* packed = new uint64_t[n];
+    sortPackedParallel(keys, n, packed);
+    #pragma omp parallel for schedule(static)
+    for(int i = 0; i < n; i++)
+    {
+        perm[i] = packedIndex(packed[i]);
+    }
+    delete[] packed;
+}
+
+// Sorts keys in place and writes payload i of the sorted order to sortedPayloads + i * payloadBytes
+inline void sortKeyPayload(int keys[], const unsigned char* payloads, unsigned char* sortedPayloads,
+                           size_t payloadBytes, int n)
+{
+    uint64_t* packed = new uint64_t[n];
+    sortPacked(keys, n, packed);
+    for(int i = 0; i < n; i++)
+    {
+        keys[i] = packedKey(packed[i]);
+    }
+    gatherPayloads(payloads, sortedPayloads, payloadBytes, packed, n);
+    delete[] packed;
+}
+
+inline void sortKeyPayloadParallel(int keys[], const unsigned char* payloads, unsigned char* sortedPayloads,
+                                   size_t payloadBytes, int n)
+{
+    uint64_t* packed = new uint64_t[n];
+    sortPackedParallel(keys, n, packed);
+    #pragma omp parallel for schedule(static)
+    for(int i = 0; i < n; i++)
+    {
+        keys[i] = packedKey(packed[i]);
+    }
+    gatherPayloadsParallel(payloads, sortedPayloads, payloadBytes, packed, n);
+    delete[] packed;
+}
+
+// Writes the records of in to out in key order (stable); the records themselves are moved once
+template<int Bytes>
+inline void sortRecordsIndirect(const Record<Bytes> in[], Record<Bytes> out[], int n)
+{
+    uint64_t* packed = new uint64_t[n];
+    for(int i = 0; i < n; i++)
+    {
+        packed[i] = packKeyIndex(in[i].key, (uint32_t)i);
+    }
+    radixSortBy(packed, n, packedDigit);
+    gatherPayloads((const unsigned char*)in, (unsigned char*)out, sizeof(Record<Bytes>), packed, n);
+    delete[] packed;
+}
+
+template<int Bytes>
+inline void sortRecordsIndirectParallel(const Record<Bytes> in[], Record<Bytes> out[], int n)
+{
+    uint64_t* packed = new uint64_t[n];
+    #pragma omp parallel for schedule(static)
+    for(int i = 0; i < n; i++)
+    {
+        packed[i] = packKeyIndex(in[i].key, (uint32_t)i);
+    }
+    radixSortByParallel(packed, n, packedDigit);
+    gatherPayloadsParallel((const unsigned char*)in, (unsigned char*)out, sizeof(Record<Bytes>), packed, n);
+    delete[] packed;
+}
+
+#endif
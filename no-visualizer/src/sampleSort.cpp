@@ -0,0 +1,36 @@
+#include <iostream>
+#include <cstdlib>
+#include <ctime>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <vector>
+#include <omp.h>
+
+#include "sampleSort.h"
+#include "benchHarness.h"
+
+int main(int argc, char* argv[]) {
+    BenchArgs args;
+    if (argc < 2 || !parseBenchArgs(argc, argv, 2, args)) {
+        std::cerr << "Usage: " << argv[0] << " <array_size> " << DISTRIBUTION_USAGE << " [--phases] [--perf] " << MAPPED_FILE_USAGE << "\n";
+        return 1;
+    }
+
+    int n = std::atoi(argv[1]);
+
+    BenchData<int> data(args, n);
+    if (!data.valid()) {
+        return 1;
+    }
+    n = data.size();
+    int* arr = data.arr;
+
+    BenchReport report(args, data);
+    // The serial baseline is the quick sort that sorts the buckets
+    report.run("Quick Sort", arr, [&] { quickSort(arr, 0, n-1); });
+    report.run("Sample Sort Parallel", arr, [&] { sampleSort(arr, n); });
+    report.print();
+
+    return report.allVerified() ? 0 : 1;
+}
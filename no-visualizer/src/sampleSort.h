@@ -0,0 +1,155 @@
+#ifndef SAMPLE_SORT_H
+#define SAMPLE_SORT_H
+
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <omp.h>
+
+#include "quickSort.h"
+#include "sortRegistry.h"
+
+/* Parallel sample sort.
+
+Quick sort and merge sort parallelize by recursive forking, so their first levels run
+on one or two threads. Sample sort spreads the work over all threads from the first
+pass instead:
+
+1.  Splitters:
+
+    A random oversample of OVERSAMPLING elements per bucket is sorted and every
+    OVERSAMPLING-th element becomes a splitter, giving k - 1 splitters for k buckets
+    (k is the number of threads rounded up to a power of two).
+
+2.  Classification:
+
+    Every thread takes a contiguous chunk and finds the bucket of each element by
+    walking an implicit binary search tree of the splitters (children of node j at 2j
+    and 2j + 1). The walk is branchless, j = 2 * j + (x > tree[j]), so it costs log2(k)
+    comparisons and no mispredictions. The bucket of every element is remembered and
+    counted in a per-thread histogram.
+
+3.  Distribution:
+
+    The per-thread histograms are prefix-summed in (bucket, thread) order and every
+    thread scatters its chunk into a scratch buffer at its own offsets.
+
+4.  Bucket sorts:
+
+    Buckets are independent, so each one is sorted with the serial introSort by
+    whichever thread picks it up and copied back into place. Presorted buckets (sorted
+    or reverse input) would make the first-element-pivot quickSort quadratic. */
+
+const int OVERSAMPLING = 32;
+
+// Fills tree[1..k) with the sorted splitters in breadth-first (Eytzinger) order
+inline void buildSplitterTree(const std::vector<int>& splitters, std::vector<int>& tree, int node, int& next)
+{
+    if(node >= (int)tree.size())
+    {
+        return;
+    }
+    buildSplitterTree(splitters, tree, 2 * node, next);
+    tree[node] = splitters[next++];
+    buildSplitterTree(splitters, tree, 2 * node + 1, next);
+}
+
+inline int classify(const int tree[], int levels, int buckets, int value)
+{
+    int j = 1;
+    for(int level = 0; level < levels; level++)
+    {
+        j = 2 * j + (value > tree[j]);
+    }
+    return j - buckets;
+}
+
+inline void sampleSort(int a[], int n)
+{
+    int nthreads = omp_get_max_threads();
+    int buckets = 1, levels = 0;
+    while(buckets < nthreads)
+    {
+        buckets <<= 1;
+        levels++;
+    }
+    if(buckets == 1 || n < buckets * OVERSAMPLING)
+    {
+        introSort(a, 0, n - 1);
+        return;
+    }
+
+    std::mt19937 gen(12345);
+    std::uniform_int_distribution<int> pick(0, n - 1);
+    std::vector<int> sample(buckets * OVERSAMPLING);
+    for(int& s : sample)
+    {
+        s = a[pick(gen)];
+    }
+    std::sort(sample.begin(), sample.end());
+
+    std::vector<int> splitters(buckets - 1);
+    for(int i = 1; i < buckets; i++)
+    {
+        splitters[i - 1] = sample[i * OVERSAMPLING];
+    }
+    std::vector<int> tree(buckets);
+    int next = 0;
+    buildSplitterTree(splitters, tree, 1, next);
+
+    int* buffer = new int[n];
+    std::vector<unsigned short> bucketOf(n);
+    std::vector<int> histograms(nthreads * buckets, 0);
+    std::vector<int> bucketStart(buckets + 1);
+
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int team = omp_get_num_threads();
+        int begin = (int)((long long)n * tid / team);
+        int end = (int)((long long)n * (tid + 1) / team);
+        int* hist = &histograms[tid * buckets];
+
+        for(int i = begin; i < end; i++)
+        {
+            int b = classify(tree.data(), levels, buckets, a[i]);
+            bucketOf[i] = (unsigned short)b;
+            hist[b]++;
+        }
+        #pragma omp barrier
+
+        #pragma omp single
+        {
+            int sum = 0;
+            for(int b = 0; b < buckets; b++)
+            {
+                bucketStart[b] = sum;
+                for(int t = 0; t < team; t++)
+                {
+                    int c = histograms[t * buckets + b];
+                    histograms[t * buckets + b] = sum;
+                    sum += c;
+                }
+            }
+            bucketStart[buckets] = sum;
+        }
+
+        for(int i = begin; i < end; i++)
+        {
+            buffer[hist[bucketOf[i]]++] = a[i];
+        }
+        #pragma omp barrier
+
+        #pragma omp for schedule(dynamic, 1)
+        for(int b = 0; b < buckets; b++)
+        {
+            introSort(buffer, bucketStart[b], bucketStart[b + 1] - 1);
+            std::copy(buffer + bucketStart[b], buffer + bucketStart[b + 1], a + bucketStart[b]);
+        }
+    }
+    delete[] buffer;
+}
+
+REGISTER_SORT(sampleSort, "sampleSort", true, sampleSort)
+
+#endif
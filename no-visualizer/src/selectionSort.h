@@ -0,0 +1,207 @@
+#ifndef SELECTION_SORT_H
+#define SELECTION_SORT_H
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include <omp.h>
+
+#include "sortRegistry.h"
+
+inline void selectionSortParallel(int* arr, int arrSize)
+/*
+In selection sort you take the smallest element of the remaining
+array and put it up next to where you know it's sorted.
+
+Because of this, the swap is still not parallelizable.
+
+However, to choose the smallest element you need comparisons which
+are parallelizable, this code aims to explore this.
+
+*/
+{
+    for(int i=0;i<arrSize-1;i++)
+    {
+        int minIndex = i;
+
+        #pragma omp parallel
+        {
+            int localMinIndex = minIndex;
+
+            #pragma omp for nowait
+            for(int j=i+1;j<arrSize;j++)
+            {
+                if(arr[j]<arr[localMinIndex])
+                {
+                    localMinIndex=j;
+                }
+            }
+            #pragma omp critical
+            if (arr[localMinIndex] < arr[minIndex]){
+                minIndex = localMinIndex;
+            }
+            
+        }
+        
+        int temp=arr[i];
+        arr[i]=arr[minIndex];
+        arr[minIndex]=temp;
+    }
+}
+
+inline void selectionSort(int* arr, int arrSize)
+{
+    int minIndex;
+    for(int i=0;i<arrSize-1;i++)
+    {
+        minIndex=i;
+        for(int j=i+1;j<arrSize;j++)
+        {
+            if(arr[j]<arr[minIndex])
+            {
+                minIndex=j;
+            }
+        }
+        int temp=arr[i];
+        arr[i]=arr[minIndex];
+        arr[minIndex]=temp;
+    }
+}
+
+struct alignas(64) MinCandidate
+{
+    int value;
+    int index;
+};
+
+inline void selectionSortReduction(int* arr, int arrSize)
+/*
+selectionSortParallel opens a parallel region and goes through a
+critical section on every outer iteration, which is n regions and
+n * p critical entries per sort.
+
+Here one team lives for the whole sort. On every iteration each
+thread finds the minimum of its share of the unsorted part with a
+vectorized min reduction and then looks up where it is, writes
+its candidate into its own cache line, and one thread picks the
+winner and does the swap. That is two barriers per iteration and
+no critical section.
+*/
+{
+    std::vector<MinCandidate> candidates(omp_get_max_threads());
+
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int p = omp_get_num_threads();
+
+        for(int i=0;i<arrSize-1;i++)
+        {
+            int remaining = arrSize - (i + 1);
+            int begin = i + 1 + (int)((long long)remaining * tid / p);
+            int end = i + 1 + (int)((long long)remaining * (tid + 1) / p);
+
+            int localMin = std::numeric_limits<int>::max();
+            #pragma omp simd reduction(min:localMin)
+            for(int j=begin;j<end;j++)
+            {
+                localMin = std::min(localMin, arr[j]);
+            }
+            int localMinIndex = -1;
+            for(int j=begin;j<end;j++)
+            {
+                if(arr[j]==localMin)
+                {
+                    localMinIndex=j;
+                    break;
+                }
+            }
+            candidates[tid].value = localMin;
+            candidates[tid].index = localMinIndex;
+            #pragma omp barrier
+
+            #pragma omp single
+            {
+                // Candidates are in index order, so ties keep the first minimum like the serial version
+                int minIndex = i;
+                for(int t=0;t<p;t++)
+                {
+                    if(candidates[t].index>=0 && candidates[t].value<arr[minIndex])
+                    {
+                        minIndex = candidates[t].index;
+                    }
+                }
+                int temp=arr[i];
+                arr[i]=arr[minIndex];
+                arr[minIndex]=temp;
+            }
+        }
+    }
+}
+
+inline int tournamentWinner(const int* arr, int a, int b)
+{
+    if(a<0) return b;
+    if(b<0) return a;
+    return (arr[b]<arr[a]) ? b : a;
+}
+
+inline void selectionSortTournament(int* arr, int arrSize)
+/*
+Selection sort over a tournament tree. The leaves hold the element
+indices, every inner node the index of the smaller of its two
+children, so the root is the minimum of the array. After a pick,
+the winner's leaf is emptied and only the log n matches on its
+path to the root are replayed, instead of scanning all remaining
+elements again.
+
+The tree is built level by level, and each level's matches are
+independent, so large levels are played in parallel.
+*/
+{
+    if(arrSize<2)
+    {
+        return;
+    }
+    int leaves=1;
+    while(leaves<arrSize)
+    {
+        leaves<<=1;
+    }
+
+    std::vector<int> tree(2*leaves, -1);
+    for(int i=0;i<arrSize;i++)
+    {
+        tree[leaves+i]=i;
+    }
+    for(int levelStart=leaves/2; levelStart>=1; levelStart/=2)
+    {
+        #pragma omp parallel for if(levelStart >= 4096)
+        for(int node=levelStart; node<2*levelStart; node++)
+        {
+            tree[node]=tournamentWinner(arr, tree[2*node], tree[2*node+1]);
+        }
+    }
+
+    std::vector<int> sorted(arrSize);
+    for(int k=0;k<arrSize;k++)
+    {
+        int winner=tree[1];
+        sorted[k]=arr[winner];
+
+        int node=leaves+winner;
+        tree[node]=-1;
+        for(node/=2; node>=1; node/=2)
+        {
+            tree[node]=tournamentWinner(arr, tree[2*node], tree[2*node+1]);
+        }
+    }
+    std::copy(sorted.begin(), sorted.end(), arr);
+}
+
+REGISTER_SORT(selectionSort, "selectionSort", false, selectionSort)
+REGISTER_SORT(selectionSortParallel, "selectionSort", true, selectionSortParallel)
+REGISTER_SORT(selectionSortReduction, "selectionSort", true, selectionSortReduction)
+REGISTER_SORT(selectionSortTournament, "selectionSort", false, selectionSortTournament)
+
+#endif
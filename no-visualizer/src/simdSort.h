@@ -0,0 +1,264 @@
+#ifndef SIMD_SORT_H
+#define SIMD_SORT_H
+
+#include <algorithm>
+#include <climits>
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+#include "phaseTimer.h"
+
+/* In-register sorting networks used as leaf sorters.
+
+The recursive sorts spend most of their cycles on tiny sub-arrays, where scalar
+compare-and-swap code is dominated by branch mispredictions. The kernels below keep
+8, 16 or 32 ints in vector registers and sort them with a bitonic network: every
+stage is a permute to line each element up with its partner, a min, a max and a
+blend, with no branches at all.
+
+The element width of a register is SIMD_WIDTH: 8 lanes with AVX2, 4 lanes with
+SSE4.1 and a single int otherwise, so the same network code runs on all three.
+Compile with -mavx2 (or -march=native) to get the AVX2 kernels. */
+
+#if defined(__AVX2__)
+
+typedef __m256i SimdVec;
+const int SIMD_WIDTH = 8;
+
+inline SimdVec simdLoad(const int* p) { return _mm256_loadu_si256((const __m256i*)p); }
+inline void simdStore(int* p, SimdVec v) { _mm256_storeu_si256((__m256i*)p, v); }
+inline SimdVec simdMin(SimdVec a, SimdVec b) { return _mm256_min_epi32(a, b); }
+inline SimdVec simdMax(SimdVec a, SimdVec b) { return _mm256_max_epi32(a, b); }
+inline SimdVec simdSelect(SimdVec mask, SimdVec ifSet, SimdVec ifClear) { return _mm256_blendv_epi8(ifClear, ifSet, mask); }
+
+inline SimdVec simdXorPermute(SimdVec v, int j)
+{
+    return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0 ^ j, 1 ^ j, 2 ^ j, 3 ^ j, 4 ^ j, 5 ^ j, 6 ^ j, 7 ^ j));
+}
+
+inline SimdVec simdReverse(SimdVec v)
+{
+    return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+#elif defined(__SSE4_1__)
+
+typedef __m128i SimdVec;
+const int SIMD_WIDTH = 4;
+
+inline SimdVec simdLoad(const int* p) { return _mm_loadu_si128((const __m128i*)p); }
+inline void simdStore(int* p, SimdVec v) { _mm_storeu_si128((__m128i*)p, v); }
+inline SimdVec simdMin(SimdVec a, SimdVec b) { return _mm_min_epi32(a, b); }
+inline SimdVec simdMax(SimdVec a, SimdVec b) { return _mm_max_epi32(a, b); }
+inline SimdVec simdSelect(SimdVec mask, SimdVec ifSet, SimdVec ifClear) { return _mm_blendv_epi8(ifClear, ifSet, mask); }
+
+inline SimdVec simdXorPermute(SimdVec v, int j)
+{
+    // Shuffles need an immediate, j is 1 or 2 here
+    if(j == 1)
+    {
+        return _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+    }
+    return _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+}
+
+inline SimdVec simdReverse(SimdVec v) { return _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3)); }
+
+#else
+
+typedef int SimdVec;
+const int SIMD_WIDTH = 1;
+
+inline SimdVec simdLoad(const int* p) { return *p; }
+inline void simdStore(int* p, SimdVec v) { *p = v; }
+inline SimdVec simdMin(SimdVec a, SimdVec b) { return std::min(a, b); }
+inline SimdVec simdMax(SimdVec a, SimdVec b) { return std::max(a, b); }
+inline SimdVec simdSelect(SimdVec mask, SimdVec ifSet, SimdVec ifClear) { return mask ? ifSet : ifClear; }
+inline SimdVec simdXorPermute(SimdVec v, int) { return v; }
+inline SimdVec simdReverse(SimdVec v) { return v; }
+
+#endif
+
+const int SIMD_SORT_MAX = 32;
+
+// In stage (k, j) element i keeps the minimum of itself and its partner i ^ j when it
+// is the lower one of an ascending pair or the upper one of a descending pair
+inline bool simdTakesMin(int i, int j, int k)
+{
+    return ((i & j) == 0) == ((i & k) == 0);
+}
+
+inline SimdVec simdLaneMask(int base, int j, int k)
+{
+#if defined(__AVX2__)
+    return _mm256_setr_epi32(-simdTakesMin(base + 0, j, k), -simdTakesMin(base + 1, j, k),
+                             -simdTakesMin(base + 2, j, k), -simdTakesMin(base + 3, j, k),
+                             -simdTakesMin(base + 4, j, k), -simdTakesMin(base + 5, j, k),
+                             -simdTakesMin(base + 6, j, k), -simdTakesMin(base + 7, j, k));
+#elif defined(__SSE4_1__)
+    return _mm_setr_epi32(-simdTakesMin(base + 0, j, k), -simdTakesMin(base + 1, j, k),
+                          -simdTakesMin(base + 2, j, k), -simdTakesMin(base + 3, j, k));
+#else
+    return simdTakesMin(base, j, k);
+#endif
+}
+
+// Sorts N ints (N a power of two, SIMD_WIDTH <= N <= SIMD_SORT_MAX) held in N / SIMD_WIDTH registers
+template<int N>
+inline void simdSortNetwork(int* data)
+{
+    const int R = N / SIMD_WIDTH;
+    SimdVec v[R];
+    for(int r = 0; r < R; r++)
+    {
+        v[r] = simdLoad(data + r * SIMD_WIDTH);
+    }
+
+    for(int k = 2; k <= N; k <<= 1)
+    {
+        for(int j = k >> 1; j > 0; j >>= 1)
+        {
+            if(j >= SIMD_WIDTH)
+            {
+                // Partners live in different registers, whole registers are compared
+                for(int r = 0; r < R; r++)
+                {
+                    int partner = r ^ (j / SIMD_WIDTH);
+                    if(partner < r)
+                    {
+                        continue;
+                    }
+                    SimdVec lo = simdMin(v[r], v[partner]);
+                    SimdVec hi = simdMax(v[r], v[partner]);
+                    bool ascending = ((r * SIMD_WIDTH) & k) == 0;
+                    v[r] = ascending ? lo : hi;
+                    v[partner] = ascending ? hi : lo;
+                }
+            }
+            else
+            {
+                for(int r = 0; r < R; r++)
+                {
+                    SimdVec partner = simdXorPermute(v[r], j);
+                    SimdVec lo = simdMin(v[r], partner);
+                    SimdVec hi = simdMax(v[r], partner);
+                    v[r] = simdSelect(simdLaneMask(r * SIMD_WIDTH, j, k), lo, hi);
+                }
+            }
+        }
+    }
+
+    for(int r = 0; r < R; r++)
+    {
+        simdStore(data + r * SIMD_WIDTH, v[r]);
+    }
+}
+
+/* Bitonic merge of two sorted registers: afterwards a holds the SIMD_WIDTH smallest
+and b the SIMD_WIDTH largest of the 2 * SIMD_WIDTH elements, both sorted. Reversing b
+makes a ++ b bitonic, so one min/max splits the halves and log2(SIMD_WIDTH) in-register
+stages sort each of them. */
+inline void simdMergeRegisters(SimdVec& a, SimdVec& b)
+{
+    SimdVec reversed = simdReverse(b);
+    SimdVec lo = simdMin(a, reversed);
+    SimdVec hi = simdMax(a, reversed);
+    for(int j = SIMD_WIDTH >> 1; j > 0; j >>= 1)
+    {
+        SimdVec mask = simdLaneMask(0, j, 2 * SIMD_WIDTH);
+        SimdVec loPartner = simdXorPermute(lo, j);
+        SimdVec hiPartner = simdXorPermute(hi, j);
+        lo = simdSelect(mask, simdMin(lo, loPartner), simdMax(lo, loPartner));
+        hi = simdSelect(mask, simdMin(hi, hiPartner), simdMax(hi, hiPartner));
+    }
+    a = lo;
+    b = hi;
+}
+
+// Sorts a[0..n) in ascending order, n <= SIMD_SORT_MAX
+inline void simdSortSmall(int a[], int n)
+{
+    if(n < 2)
+    {
+        return;
+    }
+    PhaseTimer timer(PHASE_LEAF);
+    // Pad up to the network size with INT_MAX, which sorts to the end
+    int buffer[SIMD_SORT_MAX];
+    int size = (n <= 8) ? 8 : (n <= 16) ? 16 : 32;
+    std::copy(a, a + n, buffer);
+    std::fill(buffer + n, buffer + size, INT_MAX);
+
+    if(size == 8)
+    {
+        simdSortNetwork<8>(buffer);
+    }
+    else if(size == 16)
+    {
+        simdSortNetwork<16>(buffer);
+    }
+    else
+    {
+        simdSortNetwork<32>(buffer);
+    }
+    std::copy(buffer, buffer + n, a);
+}
+
+/* Merges two sorted runs into output, SIMD_WIDTH elements at a time.
+
+The register b always holds the largest SIMD_WIDTH elements seen so far. The next
+register is loaded from the run whose next element is smaller, merged with b, and the
+smaller half is written out. Once one run has fewer than SIMD_WIDTH elements left, the
+carried register and that short remainder are merged into a small buffer, which is
+then merged with the rest of the long run. */
+inline void simdMergeRuns(const int x[], int nx, const int y[], int ny, int output[])
+{
+    int i = 0, j = 0, k = 0;
+    if(SIMD_WIDTH > 1 && nx >= SIMD_WIDTH && ny >= SIMD_WIDTH)
+    {
+        SimdVec a = simdLoad(x);
+        SimdVec b = simdLoad(y);
+        i = SIMD_WIDTH;
+        j = SIMD_WIDTH;
+        simdMergeRegisters(a, b);
+        simdStore(output, a);
+        k = SIMD_WIDTH;
+
+        while(i + SIMD_WIDTH <= nx && j + SIMD_WIDTH <= ny)
+        {
+            if(x[i] <= y[j])
+            {
+                a = simdLoad(x + i);
+                i += SIMD_WIDTH;
+            }
+            else
+            {
+                a = simdLoad(y + j);
+                j += SIMD_WIDTH;
+            }
+            simdMergeRegisters(a, b);
+            simdStore(output + k, a);
+            k += SIMD_WIDTH;
+        }
+
+        int carried[SIMD_WIDTH];
+        simdStore(carried, b);
+
+        // Merge the carried register with the short remainder first
+        bool xShort = (nx - i < SIMD_WIDTH);
+        const int* shortRun = xShort ? x + i : y + j;
+        int shortSize = xShort ? nx - i : ny - j;
+        const int* longRun = xShort ? y + j : x + i;
+        int longSize = xShort ? ny - j : nx - i;
+
+        int head[2 * SIMD_WIDTH];
+        std::merge(carried, carried + SIMD_WIDTH, shortRun, shortRun + shortSize, head);
+        std::merge(head, head + SIMD_WIDTH + shortSize, longRun, longRun + longSize, output + k);
+        return;
+    }
+    std::merge(x + i, x + nx, y + j, y + ny, output + k);
+}
+
+#endif
@@ -0,0 +1,620 @@
+#ifndef SORT_LIBRARY_H
+#define SORT_LIBRARY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include <omp.h>
+
+/* Header-only generic versions of the sorting engines.
+
+The engines in the other headers are written for int arrays and the < operator.
+The templates below take any random-access iterator range [first, last) and a
+comparator, which is a template parameter, so it is inlined like a plain < (the
+default is std::less<>). They work for any copyable, default-constructible key type;
+the benchmark (typedSort.cpp) runs them on int, int64_t, uint32_t, float and double.
+
+Every algorithm comes as a serial function and a ...Parallel one that starts its own
+OpenMP team:
+- quickSort: introsort (median of three or ninther pivot, Hoare partition that splits
+  runs of equal keys evenly, heap sort after 2 log2(n) bad levels, insertion sort
+  below INSERTION_SORT_CUTOFF). The parallel version spawns a task per side above
+  TASK_CUTOFF elements.
+- mergeSort: stable bottom-up merge sort, insertion-sorted leaves of MERGE_LEAF
+  elements and one scratch buffer used ping-pong. The parallel version splits every
+  level into equal output segments per thread with merge path (co-rank).
+- bitonicSort: the bitonic network in its all-ascending form, where the first step of
+  every merge compares i with its mirror in the block. Then every compare-exchange
+  puts the smaller key first, so any n works: the missing elements up to the next
+  power of two behave like +infinity and their compare-exchanges are skipped.
+- heapSort: binary heap sort. The parallel version heap-sorts one chunk per thread
+  and merges the chunks like the parallel merge sort.
+- selectionSort and bubbleSort: the quadratic algorithms, with a per-thread minimum
+  search and odd-even transposition respectively. */
+namespace sortlib
+{
+
+const std::ptrdiff_t INSERTION_SORT_CUTOFF = 24;
+const std::ptrdiff_t TASK_CUTOFF = 10000;
+const std::ptrdiff_t MERGE_LEAF = 32;
+
+namespace detail
+{
+
+template<class It>
+using Value = typename std::iterator_traits<It>::value_type;
+
+template<class It, class Compare>
+inline void insertionSort(It first, It last, Compare comp)
+{
+    if(first == last)
+    {
+        return;
+    }
+    for(It i = first + 1; i != last; ++i)
+    {
+        Value<It> value = std::move(*i);
+        It j = i;
+        while(j != first && comp(value, *(j - 1)))
+        {
+            *j = std::move(*(j - 1));
+            --j;
+        }
+        *j = std::move(value);
+    }
+}
+
+template<class It, class Compare>
+inline It medianOfThree(It a, It b, It c, Compare comp)
+{
+    if(comp(*a, *b))
+    {
+        if(comp(*b, *c)) return b;
+        return comp(*a, *c) ? c : a;
+    }
+    if(comp(*a, *c)) return a;
+    return comp(*b, *c) ? c : b;
+}
+
+// Moves the median of three (or Tukey's ninther for 128 or more keys) to *first
+template<class It, class Compare>
+inline void movePivotToFront(It first, It last, Compare comp)
+{
+    std::ptrdiff_t size = last - first;
+    It mid = first + size / 2;
+    It pivot;
+    if(size < 128)
+    {
+        pivot = medianOfThree(first, mid, last - 1, comp);
+    }
+    else
+    {
+        std::ptrdiff_t step = size / 8;
+        It a = medianOfThree(first, first + step, first + 2 * step, comp);
+        It b = medianOfThree(mid - step, mid, mid + step, comp);
+        It c = medianOfThree(last - 1 - 2 * step, last - 1 - step, last - 1, comp);
+        pivot = medianOfThree(a, b, c, comp);
+    }
+    std::iter_swap(first, pivot);
+}
+
+// Hoare partition around *first. Both scans stop on keys equal to the pivot, so runs of
+// equal keys are split evenly. Returns the final position of the pivot.
+template<class It, class Compare>
+inline It hoarePartition(It first, It last, Compare comp)
+{
+    Value<It> pivot = *first;
+    It i = first + 1;
+    It j = last - 1;
+    while(true)
+    {
+        while(i <= j && comp(*i, pivot))
+        {
+            ++i;
+        }
+        while(i <= j && comp(pivot, *j))
+        {
+            --j;
+        }
+        if(i >= j)
+        {
+            break;
+        }
+        std::iter_swap(i, j);
+        ++i;
+        --j;
+    }
+    std::iter_swap(first, j);
+    return j;
+}
+
+template<class It, class Compare>
+inline void siftDown(It first, std::ptrdiff_t root, std::ptrdiff_t size, Compare comp)
+{
+    Value<It> value = std::move(first[root]);
+    std::ptrdiff_t child = 2 * root + 1;
+    while(child < size)
+    {
+        if(child + 1 < size && comp(first[child], first[child + 1]))
+        {
+            child++;
+        }
+        if(!comp(value, first[child]))
+        {
+            break;
+        }
+        first[root] = std::move(first[child]);
+        root = child;
+        child = 2 * root + 1;
+    }
+    first[root] = std::move(value);
+}
+
+template<class It, class Compare>
+inline void heapSort(It first, It last, Compare comp)
+{
+    std::ptrdiff_t size = last - first;
+    for(std::ptrdiff_t root = size / 2 - 1; root >= 0; root--)
+    {
+        siftDown(first, root, size, comp);
+    }
+    for(std::ptrdiff_t end = size - 1; end > 0; end--)
+    {
+        std::iter_swap(first, first + end);
+        siftDown(first, 0, end, comp);
+    }
+}
+
+inline int depthLimit(std::ptrdiff_t size)
+{
+    int depth = 0;
+    while(size > 1)
+    {
+        size >>= 1;
+        depth++;
+    }
+    return 2 * depth;
+}
+
+template<class It, class Compare>
+inline void introSort(It first, It last, int depth, Compare comp)
+{
+    while(last - first > INSERTION_SORT_CUTOFF)
+    {
+        if(depth == 0)
+        {
+            heapSort(first, last, comp);
+            return;
+        }
+        depth--;
+        movePivotToFront(first, last, comp);
+        It cut = hoarePartition(first, last, comp);
+        // Recurse into the smaller side, loop on the larger one
+        if(cut - first < last - cut)
+        {
+            introSort(first, cut, depth, comp);
+            first = cut + 1;
+        }
+        else
+        {
+            introSort(cut + 1, last, depth, comp);
+            last = cut;
+        }
+    }
+    insertionSort(first, last, comp);
+}
+
+// No taskwait: the sides are independent and the barrier at the end of the team's
+// single region waits for every task
+template<class It, class Compare>
+inline void introSortTask(It first, It last, int depth, Compare comp)
+{
+    if(last - first <= TASK_CUTOFF || depth == 0)
+    {
+        introSort(first, last, depth, comp);
+        return;
+    }
+    movePivotToFront(first, last, comp);
+    It cut = hoarePartition(first, last, comp);
+
+    #pragma omp task
+    introSortTask(first, cut, depth - 1, comp);
+
+    #pragma omp task
+    introSortTask(cut + 1, last, depth - 1, comp);
+}
+
+// Merges [x, x + nx) and [y, y + ny) into out, taking ties from x (stable)
+template<class InIt, class OutIt, class Compare>
+inline void mergeRuns(InIt x, std::ptrdiff_t nx, InIt y, std::ptrdiff_t ny, OutIt out, Compare comp)
+{
+    InIt xEnd = x + nx;
+    InIt yEnd = y + ny;
+    while(x != xEnd && y != yEnd)
+    {
+        if(comp(*y, *x))
+        {
+            *out = std::move(*y);
+            ++y;
+        }
+        else
+        {
+            *out = std::move(*x);
+            ++x;
+        }
+        ++out;
+    }
+    out = std::move(x, xEnd, out);
+    std::move(y, yEnd, out);
+}
+
+// Number of the first k merged elements that come from x (see coRank in mergeSort.h)
+template<class It, class Compare>
+inline std::ptrdiff_t coRank(std::ptrdiff_t k, It x, std::ptrdiff_t nx, It y, std::ptrdiff_t ny, Compare comp)
+{
+    std::ptrdiff_t lo = (k > ny) ? k - ny : 0;
+    std::ptrdiff_t hi = (k < nx) ? k : nx;
+    while(lo < hi)
+    {
+        std::ptrdiff_t i = lo + (hi - lo) / 2;
+        std::ptrdiff_t j = k - i;
+        if(comp(y[j - 1], x[i]))
+        {
+            hi = i;
+        }
+        else
+        {
+            lo = i + 1;
+        }
+    }
+    return lo;
+}
+
+/* Merges the pairs of adjacent runs (0, 1), (2, 3), ... of src into dst, but only the
+output positions [kBegin, kEnd). Run r starts at bound(r) and bound(runs) is the end of
+the data; an odd last run is copied. */
+template<class InIt, class OutIt, class Bound, class Compare>
+inline void mergePairsSegment(InIt src, OutIt dst, Bound bound, std::ptrdiff_t runs,
+                              std::ptrdiff_t kBegin, std::ptrdiff_t kEnd, Compare comp)
+{
+    std::ptrdiff_t pairs = (runs + 1) / 2;
+    // Last pair that starts at or before kBegin
+    std::ptrdiff_t lo = 0, hi = pairs - 1;
+    while(lo < hi)
+    {
+        std::ptrdiff_t q = lo + (hi - lo + 1) / 2;
+        if(bound(2 * q) <= kBegin)
+        {
+            lo = q;
+        }
+        else
+        {
+            hi = q - 1;
+        }
+    }
+    for(std::ptrdiff_t q = lo; q < pairs && bound(2 * q) < kEnd; q++)
+    {
+        std::ptrdiff_t pairStart = bound(2 * q);
+        std::ptrdiff_t mid = bound(std::min(2 * q + 1, runs));
+        std::ptrdiff_t end = bound(std::min(2 * q + 2, runs));
+        std::ptrdiff_t segBegin = std::max(kBegin, pairStart) - pairStart;
+        std::ptrdiff_t segEnd = std::min(kEnd, end) - pairStart;
+        if(segBegin >= segEnd)
+        {
+            continue;
+        }
+        InIt x = src + pairStart;
+        InIt y = src + mid;
+        std::ptrdiff_t nx = mid - pairStart;
+        std::ptrdiff_t ny = end - mid;
+        std::ptrdiff_t iBegin = coRank(segBegin, x, nx, y, ny, comp);
+        std::ptrdiff_t iEnd = coRank(segEnd, x, nx, y, ny, comp);
+        std::ptrdiff_t jBegin = segBegin - iBegin;
+        std::ptrdiff_t jEnd = segEnd - iEnd;
+        mergeRuns(x + iBegin, iEnd - iBegin, y + jBegin, jEnd - jBegin, dst + pairStart + segBegin, comp);
+    }
+}
+
+/* Merges runs pairwise, level by level, until one is left, alternating between the range
+and buffer. At level l run r starts at bound(l, r). Called by every thread of a team
+(or outside any parallel region, with thread 0 of 1): each thread writes an equal share
+of every level, and the levels are separated by barriers. */
+template<class It, class T, class Bound, class Compare>
+inline void mergeLevels(It first, T* buffer, std::ptrdiff_t n, std::ptrdiff_t runs, Bound bound,
+                        int tid, int nthreads, Compare comp)
+{
+    std::ptrdiff_t kBegin = n * tid / nthreads;
+    std::ptrdiff_t kEnd = n * (tid + 1) / nthreads;
+    bool inBuffer = false;
+    for(int level = 0; runs > 1; level++, runs = (runs + 1) / 2)
+    {
+        auto levelBound = [&](std::ptrdiff_t r) { return bound(level, r); };
+        if(inBuffer)
+        {
+            mergePairsSegment(buffer, first, levelBound, runs, kBegin, kEnd, comp);
+        }
+        else
+        {
+            mergePairsSegment(first, buffer, levelBound, runs, kBegin, kEnd, comp);
+        }
+        inBuffer = !inBuffer;
+        #pragma omp barrier
+    }
+    if(inBuffer)
+    {
+        std::move(buffer + kBegin, buffer + kEnd, first + kBegin);
+    }
+}
+
+// Compare-exchanges of one stage of the all-ascending bitonic network, for the pairs
+// [pBegin, pEnd). The partner of i is its mirror in the block (first step of a merge)
+// or i + j; partners beyond n are +infinity and are skipped.
+template<class It, class Compare>
+inline void bitonicStage(It first, std::ptrdiff_t n, std::ptrdiff_t j, bool mirror,
+                         std::ptrdiff_t pBegin, std::ptrdiff_t pEnd, Compare comp)
+{
+    for(std::ptrdiff_t p = pBegin; p < pEnd; p++)
+    {
+        std::ptrdiff_t i = ((p & ~(j - 1)) << 1) | (p & (j - 1));
+        std::ptrdiff_t l = mirror ? (i ^ (2 * j - 1)) : (i + j);
+        if(l >= n)
+        {
+            continue;
+        }
+        Value<It> a = first[i];
+        Value<It> b = first[l];
+        bool swap = comp(b, a);
+        first[i] = swap ? b : a;
+        first[l] = swap ? a : b;
+    }
+}
+
+inline std::ptrdiff_t nextPowerOfTwo(std::ptrdiff_t n)
+{
+    std::ptrdiff_t size = 1;
+    while(size < n)
+    {
+        size <<= 1;
+    }
+    return size;
+}
+
+struct alignas(64) MinIndex
+{
+    std::ptrdiff_t index;
+};
+
+}  // namespace detail
+
+template<class RandomIt, class Compare = std::less<>>
+inline void quickSort(RandomIt first, RandomIt last, Compare comp = Compare())
+{
+    detail::introSort(first, last, detail::depthLimit(last - first), comp);
+}
+
+template<class RandomIt, class Compare = std::less<>>
+inline void quickSortParallel(RandomIt first, RandomIt last, Compare comp = Compare())
+{
+    #pragma omp parallel
+    {
+        #pragma omp single
+        detail::introSortTask(first, last, detail::depthLimit(last - first), comp);
+    }
+}
+
+template<class RandomIt, class Compare = std::less<>>
+inline void mergeSort(RandomIt first, RandomIt last, Compare comp = Compare())
+{
+    std::ptrdiff_t n = last - first;
+    for(std::ptrdiff_t leaf = 0; leaf < n; leaf += MERGE_LEAF)
+    {
+        detail::insertionSort(first + leaf, first + std::min(n, leaf + MERGE_LEAF), comp);
+    }
+    if(n <= MERGE_LEAF)
+    {
+        return;
+    }
+    std::vector<detail::Value<RandomIt>> buffer(n);
+    auto bound = [n](int level, std::ptrdiff_t r) { return std::min(r * (MERGE_LEAF << level), n); };
+    detail::mergeLevels(first, buffer.data(), n, (n + MERGE_LEAF - 1) / MERGE_LEAF, bound, 0, 1, comp);
+}
+
+template<class RandomIt, class Compare = std::less<>>
+inline void mergeSortParallel(RandomIt first, RandomIt last, Compare comp = Compare())
+{
+    std::ptrdiff_t n = last - first;
+    if(n <= MERGE_LEAF)
+    {
+        detail::insertionSort(first, last, comp);
+        return;
+    }
+    std::vector<detail::Value<RandomIt>> buffer(n);
+    auto bound = [n](int level, std::ptrdiff_t r) { return std::min(r * (MERGE_LEAF << level), n); };
+    #pragma omp parallel
+    {
+        #pragma omp for schedule(static)
+        for(std::ptrdiff_t leaf = 0; leaf < n; leaf += MERGE_LEAF)
+        {
+            detail::insertionSort(first + leaf, first + std::min(n, leaf + MERGE_LEAF), comp);
+        }
+        detail::mergeLevels(first, buffer.data(), n, (n + MERGE_LEAF - 1) / MERGE_LEAF, bound,
+                            omp_get_thread_num(), omp_get_num_threads(), comp);
+    }
+}
+
+template<class RandomIt, class Compare = std::less<>>
+inline void bitonicSort(RandomIt first, RandomIt last, Compare comp = Compare())
+{
+    std::ptrdiff_t n = last - first;
+    for(std::ptrdiff_t leaf = 0; leaf < n; leaf += MERGE_LEAF)
+    {
+        detail::insertionSort(first + leaf, first + std::min(n, leaf + MERGE_LEAF), comp);
+    }
+    std::ptrdiff_t size = detail::nextPowerOfTwo(n);
+    for(std::ptrdiff_t k = 2 * MERGE_LEAF; k <= size; k <<= 1)
+    {
+        for(std::ptrdiff_t j = k >> 1; j > 0; j >>= 1)
+        {
+            detail::bitonicStage(first, n, j, j == k >> 1, 0, size / 2, comp);
+        }
+    }
+}
+
+template<class RandomIt, class Compare = std::less<>>
+inline void bitonicSortParallel(RandomIt first, RandomIt last, Compare comp = Compare())
+{
+    std::ptrdiff_t n = last - first;
+    std::ptrdiff_t size = detail::nextPowerOfTwo(n);
+    #pragma omp parallel
+    {
+        #pragma omp for schedule(static)
+        for(std::ptrdiff_t leaf = 0; leaf < n; leaf += MERGE_LEAF)
+        {
+            detail::insertionSort(first + leaf, first + std::min(n, leaf + MERGE_LEAF), comp);
+        }
+        std::ptrdiff_t pairs = size / 2;
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        std::ptrdiff_t pBegin = pairs * tid / nthreads;
+        std::ptrdiff_t pEnd = pairs * (tid + 1) / nthreads;
+        for(std::ptrdiff_t k = 2 * MERGE_LEAF; k <= size; k <<= 1)
+        {
+            for(std::ptrdiff_t j = k >> 1; j > 0; j >>= 1)
+            {
+                detail::bitonicStage(first, n, j, j == k >> 1, pBegin, pEnd, comp);
+                #pragma omp barrier
+            }
+        }
+    }
+}
+
+template<class RandomIt, class Compare = std::less<>>
+inline void heapSort(RandomIt first, RandomIt last, Compare comp = Compare())
+{
+    detail::heapSort(first, last, comp);
+}
+
+template<class RandomIt, class Compare = std::less<>>
+inline void heapSortParallel(RandomIt first, RandomIt last, Compare comp = Compare())
+{
+    std::ptrdiff_t n = last - first;
+    std::vector<detail::Value<RandomIt>> buffer(n);
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        std::ptrdiff_t chunks = omp_get_num_threads();
+        detail::heapSort(first + n * tid / chunks, first + n * (tid + 1) / chunks, comp);
+        #pragma omp barrier
+
+        // At level l, run r is made of the chunks [r * 2^l, (r + 1) * 2^l)
+        auto bound = [n, chunks](int level, std::ptrdiff_t r) { return n * std::min(r << level, chunks) / chunks; };
+        detail::mergeLevels(first, buffer.data(), n, chunks, bound, tid, (int)chunks, comp);
+    }
+}
+
+template<class RandomIt, class Compare = std::less<>>
+inline void selectionSort(RandomIt first, RandomIt last, Compare comp = Compare())
+{
+    for(RandomIt i = first; i != last; ++i)
+    {
+        RandomIt best = i;
+        for(RandomIt j = i + 1; j != last; ++j)
+        {
+            if(comp(*j, *best))
+            {
+                best = j;
+            }
+        }
+        std::iter_swap(i, best);
+    }
+}
+
+template<class RandomIt, class Compare = std::less<>>
+inline void selectionSortParallel(RandomIt first, RandomIt last, Compare comp = Compare())
+{
+    std::ptrdiff_t n = last - first;
+    std::vector<detail::MinIndex> candidates(omp_get_max_threads());
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        for(std::ptrdiff_t i = 0; i + 1 < n; i++)
+        {
+            // Every thread finds the minimum of its share of [i, n), one thread picks among them
+            std::ptrdiff_t local = i;
+            #pragma omp for schedule(static) nowait
+            for(std::ptrdiff_t j = i + 1; j < n; j++)
+            {
+                if(comp(first[j], first[local]))
+                {
+                    local = j;
+                }
+            }
+            candidates[tid].index = local;
+            #pragma omp barrier
+            #pragma omp single
+            {
+                std::ptrdiff_t best = candidates[0].index;
+                for(int t = 1; t < nthreads; t++)
+                {
+                    if(comp(first[candidates[t].index], first[best]))
+                    {
+                        best = candidates[t].index;
+                    }
+                }
+                std::iter_swap(first + i, first + best);
+            }
+        }
+    }
+}
+
+template<class RandomIt, class Compare = std::less<>>
+inline void bubbleSort(RandomIt first, RandomIt last, Compare comp = Compare())
+{
+    std::ptrdiff_t n = last - first;
+    for(std::ptrdiff_t end = n - 1; end > 0; end--)
+    {
+        bool swapped = false;
+        for(std::ptrdiff_t j = 0; j < end; j++)
+        {
+            if(comp(first[j + 1], first[j]))
+            {
+                std::iter_swap(first + j, first + j + 1);
+                swapped = true;
+            }
+        }
+        if(!swapped)
+        {
+            return;
+        }
+    }
+}
+
+// Odd-even transposition sort: n phases of independent compare-exchanges, one team for all of them
+template<class RandomIt, class Compare = std::less<>>
+inline void bubbleSortParallel(RandomIt first, RandomIt last, Compare comp = Compare())
+{
+    std::ptrdiff_t n = last - first;
+    #pragma omp parallel
+    {
+        for(std::ptrdiff_t phase = 0; phase < n; phase++)
+        {
+            #pragma omp for schedule(static)
+            for(std::ptrdiff_t j = phase % 2; j < n - 1; j += 2)
+            {
+                detail::Value<RandomIt> a = first[j];
+                detail::Value<RandomIt> b = first[j + 1];
+                bool swap = comp(b, a);
+                first[j] = swap ? b : a;
+                first[j + 1] = swap ? a : b;
+            }
+        }
+    }
+}
+
+}  // namespace sortlib
+
+#endif
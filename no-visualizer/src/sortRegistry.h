@@ -0,0 +1,52 @@
+#ifndef SORT_REGISTRY_H
+#define SORT_REGISTRY_H
+
+#include <string>
+#include <vector>
+
+/* Registry of the sorting engines.
+
+Every engine header registers its serial and parallel entry points with REGISTER_SORT,
+behind a common "sort a[0..n)" signature, so sortbench can find and run all of them
+from one process. family groups an engine with its serial/parallel counterparts and
+parallel tells whether it uses the OpenMP team. */
+typedef void (*SortFunction)(int* a, int n);
+
+struct SortEngine
+{
+    std::string name;
+    std::string family;
+    bool parallel;
+    SortFunction run;
+};
+
+inline std::vector<SortEngine>& sortRegistry()
+{
+    static std::vector<SortEngine> engines;
+    return engines;
+}
+
+struct SortRegistrar
+{
+    SortRegistrar(const char* name, const char* family, bool parallel, SortFunction run)
+    {
+        sortRegistry().push_back(SortEngine{name, family, parallel, run});
+    }
+};
+
+inline const SortEngine* findSortEngine(const std::string& name)
+{
+    for(const SortEngine& engine : sortRegistry())
+    {
+        if(engine.name == name)
+        {
+            return &engine;
+        }
+    }
+    return nullptr;
+}
+
+#define REGISTER_SORT(name, family, parallel, run) \
+    static SortRegistrar sortRegistrar_##name(#name, family, parallel, run);
+
+#endif
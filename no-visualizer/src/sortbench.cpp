@@ -0,0 +1,812 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <unistd.h>
+#include <omp.h>
+
+#include "bubbleSort.h"
+#include "selectionSort.h"
+#include "mergeSort.h"
+#include "quickSort.h"
+#include "bitonicSort.h"
+#include "radixSort.h"
+#include "sampleSort.h"
+#include "heapSort.h"
+#include "insertionSort.h"
+#include "adaptiveSort.h"
+#include "benchHarness.h"
+
+/* Single in-process benchmark driver.
+
+The per-algorithm binaries start a new process for every run, so small sizes are
+dominated by process startup, first-touch page faults and OpenMP team creation.
+sortbench runs every registered engine from one process instead:
+- the input of each size is generated once, from the chosen distribution and seed,
+  and the buffers are allocated once for the largest size, so timed runs never
+  allocate their data;
+- the OpenMP team is started before the first measurement;
+- every (engine, size) pair gets untimed warmup runs before the timed repetitions;
+- every timed run is verified (sorted, and a permutation of the input); an engine
+  that fails is reported and stops being measured, and sortbench exits with 1;
+- with --phases every run also records the partition / merge / leaf-sort thread time,
+  and with --perf the hardware counters of perfCounters.h (left empty if unavailable);
+- results are written as a table, CSV or JSON, one row per timed run.
+
+Scaling mode (--scaling strong|weak|both) runs the parallel engines once per thread
+count of --threads (default 1, 2, 4, ... up to the number of processors). Strong
+scaling keeps every size fixed; weak scaling multiplies it by the thread count, so
+every thread always has the same share of the work. The table then reports, per
+engine and size, the median time at each thread count with the speedup and the
+parallel efficiency relative to the smallest thread count of the list (normally 1).
+--bind and --places set OMP_PROC_BIND and OMP_PLACES; the OpenMP runtime only reads
+them at startup, so sortbench sets them and restarts itself.
+
+--autotune searches the tunables of tuning.h instead of benchmarking: for every
+tunable whose engine is selected and every thread count of --threads (default: the
+default team; serial engines only at 1 thread) it times the engine with each value
+from the tunable's range, doubling at every step, over --sizes (default 2^20), keeps
+the value with the lowest sum of median times and writes it to the tuning cache
+(--tuning-cache, default tuningCache.txt or $SORT_TUNING_CACHE), which all binaries
+read at startup.
+
+Usage: sortbench [--sizes 2^10,2^12,65536] [--engines quickSort,quickSortParallel]
+                 [--reps 10] [--warmup 1] [--seed 42] [--dist uniform] [--dist-param X]
+                 [--scaling strong|weak|both] [--threads 1,2,4,8] [--bind close|spread|...]
+                 [--places cores|threads|sockets|...] [--autotune] [--tuning-cache file]
+                 [--format table|csv|json] [--output file] [--phases] [--perf] [--list] */
+
+struct BenchResult
+{
+    const SortEngine* engine;
+    Distribution distribution;
+    const char* series;  // "fixed" outside scaling mode, otherwise "strong" or "weak"
+    int threads;
+    int size;
+    int rep;
+    long long timeNs;
+    long long phaseNs[PHASE_COUNT];
+    PerfSample counters;
+};
+
+struct BenchOptions
+{
+    std::vector<int> sizes;
+    std::vector<std::string> engines;
+    int reps = 10;
+    int warmup = 1;
+    DistributionOptions input;
+    std::string scaling;
+    std::vector<int> threads;
+    std::string bind;
+    std::string places;
+    bool autotune = false;
+    std::string tuningCache;
+    std::string format = "table";
+    std::string output;
+    bool phases = false;
+    bool perf = false;
+    bool list = false;
+};
+
+std::vector<std::string> splitList(const std::string& list)
+{
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    std::string item;
+    while(std::getline(stream, item, ','))
+    {
+        if(!item.empty())
+        {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+// Accepts plain element counts and powers of two written as 2^k, from 0 up to INT_MAX elements
+bool parseSize(const std::string& text, int& size)
+{
+    long long value;
+    if(text.size() > 2 && text.compare(0, 2, "2^") == 0)
+    {
+        long long exponent = std::atoll(text.c_str() + 2);
+        if(exponent < 0 || exponent > 30)
+        {
+            return false;
+        }
+        value = 1LL << exponent;
+    }
+    else
+    {
+        value = std::atoll(text.c_str());
+    }
+    if(value < 0 || value > INT_MAX)
+    {
+        return false;
+    }
+    size = (int)value;
+    return true;
+}
+
+void printUsage(const char* program)
+{
+    std::cerr << "Usage: " << program << " [--sizes 2^10,2^12,65536] [--engines name,name]"
+              << " [--reps N] [--warmup N] [--seed N] [--dist name] [--dist-param X]"
+              << " [--scaling strong|weak|both] [--threads 1,2,4] [--bind policy] [--places places]"
+              << " [--autotune] [--tuning-cache file]"
+              << " [--format table|csv|json] [--output file] [--phases] [--perf] [--list]\n";
+}
+
+bool parseOptions(int argc, char* argv[], BenchOptions& options)
+{
+    for(int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if(arg == "--list")
+        {
+            options.list = true;
+            continue;
+        }
+        if(arg == "--phases")
+        {
+            options.phases = true;
+            continue;
+        }
+        if(arg == "--perf")
+        {
+            options.perf = true;
+            continue;
+        }
+        if(arg == "--autotune")
+        {
+            options.autotune = true;
+            continue;
+        }
+        if(i + 1 >= argc)
+        {
+            std::cerr << "Missing value for " << arg << "\n";
+            return false;
+        }
+        std::string value = argv[++i];
+        if(arg == "--sizes")
+        {
+            options.sizes.clear();
+            for(const std::string& size : splitList(value))
+            {
+                int elements;
+                if(!parseSize(size, elements))
+                {
+                    std::cerr << "Invalid value " << size << " for --sizes, expected 0 to " << INT_MAX << " elements or 2^k with k up to 30\n";
+                    return false;
+                }
+                options.sizes.push_back(elements);
+            }
+        }
+        else if(arg == "--engines")
+        {
+            options.engines = splitList(value);
+        }
+        else if(arg == "--reps")
+        {
+            options.reps = std::atoi(value.c_str());
+            if(options.reps < 1)
+            {
+                std::cerr << "Invalid value " << value << " for --reps, expected at least 1\n";
+                return false;
+            }
+        }
+        else if(arg == "--warmup")
+        {
+            options.warmup = std::atoi(value.c_str());
+            if(options.warmup < 0)
+            {
+                std::cerr << "Invalid value " << value << " for --warmup, expected at least 0\n";
+                return false;
+            }
+        }
+        else if(arg == "--scaling")
+        {
+            options.scaling = value;
+        }
+        else if(arg == "--threads")
+        {
+            options.threads.clear();
+            for(const std::string& count : splitList(value))
+            {
+                options.threads.push_back(std::atoi(count.c_str()));
+            }
+        }
+        else if(arg == "--bind")
+        {
+            options.bind = value;
+        }
+        else if(arg == "--places")
+        {
+            options.places = value;
+        }
+        else if(arg == "--tuning-cache")
+        {
+            options.tuningCache = value;
+        }
+        else if(arg == "--format")
+        {
+            options.format = value;
+        }
+        else if(arg == "--output")
+        {
+            options.output = value;
+        }
+        else
+        {
+            bool valid = true;
+            if(!parseDistributionOption(arg, value, options.input, valid))
+            {
+                std::cerr << "Unknown option " << arg << "\n";
+                return false;
+            }
+            if(!valid)
+            {
+                return false;
+            }
+        }
+    }
+    if(options.sizes.empty())
+    {
+        // The cutoffs matter most for large inputs
+        options.sizes.push_back(options.autotune ? 1 << 20 : 1 << 16);
+    }
+    if(options.autotune && !options.scaling.empty())
+    {
+        std::cerr << "--autotune and --scaling cannot be combined\n";
+        return false;
+    }
+    if(options.tuningCache.empty())
+    {
+        options.tuningCache = tuningCachePath();
+    }
+    if(!options.threads.empty() && options.scaling.empty() && !options.autotune)
+    {
+        options.scaling = "strong";
+    }
+    if(!options.scaling.empty() && options.scaling != "strong" && options.scaling != "weak" && options.scaling != "both")
+    {
+        std::cerr << "Unknown scaling " << options.scaling << ", expected strong, weak or both\n";
+        return false;
+    }
+    for(int count : options.threads)
+    {
+        if(count < 1)
+        {
+            std::cerr << "Thread counts must be at least 1\n";
+            return false;
+        }
+    }
+    if(options.format != "table" && options.format != "csv" && options.format != "json")
+    {
+        std::cerr << "Unknown format " << options.format << ", expected table, csv or json\n";
+        return false;
+    }
+    return true;
+}
+
+// "leaf sort" -> "leaf_sort_ns"
+std::string phaseColumn(const std::string& phase)
+{
+    std::string column = phase;
+    std::replace(column.begin(), column.end(), ' ', '_');
+    return column + "_ns";
+}
+
+void writeCsv(std::ostream& out, const std::vector<BenchResult>& results)
+{
+    out << "engine,family,parallel,distribution,series,threads,size,rep,time_ns";
+    for(const char* phase : PHASE_NAMES)
+    {
+        out << "," << phaseColumn(phase);
+    }
+    for(const char* counter : PERF_COUNTER_COLUMNS)
+    {
+        out << "," << counter;
+    }
+    out << "\n";
+    for(const BenchResult& r : results)
+    {
+        out << r.engine->name << "," << r.engine->family << "," << (r.engine->parallel ? 1 : 0) << ","
+            << distributionName(r.distribution) << "," << r.series << ","
+            << r.threads << "," << r.size << "," << r.rep << "," << r.timeNs;
+        for(long long ns : r.phaseNs)
+        {
+            out << "," << ns;
+        }
+        for(int c = 0; c < PERF_COUNTER_COUNT; c++)
+        {
+            out << ",";
+            if(r.counters.valid[c])
+            {
+                out << r.counters.value[c];
+            }
+        }
+        out << "\n";
+    }
+}
+
+void writeJson(std::ostream& out, const std::vector<BenchResult>& results)
+{
+    out << "[\n";
+    for(size_t i = 0; i < results.size(); i++)
+    {
+        const BenchResult& r = results[i];
+        out << "  {\"engine\": \"" << r.engine->name << "\", \"family\": \"" << r.engine->family
+            << "\", \"parallel\": " << (r.engine->parallel ? "true" : "false")
+            << ", \"distribution\": \"" << distributionName(r.distribution) << "\", \"series\": \"" << r.series << "\""
+            << ", \"threads\": " << r.threads << ", \"size\": " << r.size << ", \"rep\": " << r.rep
+            << ", \"time_ns\": " << r.timeNs;
+        for(int p = 0; p < PHASE_COUNT; p++)
+        {
+            out << ", \"" << phaseColumn(PHASE_NAMES[p]) << "\": " << r.phaseNs[p];
+        }
+        for(int c = 0; c < PERF_COUNTER_COUNT; c++)
+        {
+            out << ", \"" << PERF_COUNTER_COLUMNS[c] << "\": ";
+            if(r.counters.valid[c])
+            {
+                out << r.counters.value[c];
+            }
+            else
+            {
+                out << "null";
+            }
+        }
+        out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "]\n";
+}
+
+// One line per (engine, size) with the median, minimum and mean of the repetitions
+void writeTable(std::ostream& out, const std::vector<BenchResult>& results)
+{
+    out << std::left << std::setw(32) << "engine" << std::right << std::setw(10) << "size"
+        << std::setw(14) << "median ms" << std::setw(14) << "min ms" << std::setw(14) << "mean ms" << "\n";
+    size_t i = 0;
+    while(i < results.size())
+    {
+        size_t j = i;
+        std::vector<long long> times;
+        while(j < results.size() && results[j].engine == results[i].engine && results[j].size == results[i].size)
+        {
+            times.push_back(results[j].timeNs);
+            j++;
+        }
+        std::sort(times.begin(), times.end());
+        double mean = 0;
+        for(long long t : times)
+        {
+            mean += t;
+        }
+        mean /= times.size();
+
+        out << std::left << std::setw(32) << results[i].engine->name << std::right << std::setw(10) << results[i].size
+            << std::fixed << std::setprecision(3)
+            << std::setw(14) << times[times.size() / 2] / 1e6
+            << std::setw(14) << times.front() / 1e6
+            << std::setw(14) << mean / 1e6 << "\n";
+        i = j;
+    }
+}
+
+// Strong and weak scaling: median time per thread count, with speedup and efficiency
+// relative to the smallest thread count measured for the same engine and size
+void writeScalingTable(std::ostream& out, const std::vector<BenchResult>& results)
+{
+    // (series, engine, size per run or per thread) -> threads -> times
+    std::map<std::tuple<std::string, std::string, int>, std::map<int, std::vector<long long>>> groups;
+    for(const BenchResult& r : results)
+    {
+        bool weak = std::string(r.series) == "weak";
+        groups[std::make_tuple(r.series, r.engine->name, weak ? r.size / r.threads : r.size)][r.threads].push_back(r.timeNs);
+    }
+
+    out << std::left << std::setw(8) << "series" << std::setw(32) << "engine" << std::right << std::setw(8) << "threads"
+        << std::setw(12) << "size" << std::setw(14) << "median ms" << std::setw(10) << "speedup" << std::setw(12) << "efficiency" << "\n";
+    for(auto& group : groups)
+    {
+        bool weak = std::get<0>(group.first) == "weak";
+        int baseThreads = group.second.begin()->first;
+        double baseTime = 0;
+        for(auto& run : group.second)
+        {
+            std::vector<long long>& times = run.second;
+            std::sort(times.begin(), times.end());
+            double median = (double)times[times.size() / 2];
+            if(run.first == baseThreads)
+            {
+                baseTime = median;
+            }
+            int threads = run.first;
+            double ratio = (double)threads / baseThreads;
+            // Weak scaling does ratio times the work, so its speedup is the scaled speedup
+            double speedup = weak ? ratio * baseTime / median : baseTime / median;
+            out << std::left << std::setw(8) << std::get<0>(group.first) << std::setw(32) << std::get<1>(group.first)
+                << std::right << std::setw(8) << threads
+                << std::setw(12) << (weak ? std::get<2>(group.first) * threads : std::get<2>(group.first))
+                << std::fixed << std::setprecision(3) << std::setw(14) << median / 1e6
+                << std::setprecision(2) << std::setw(10) << speedup << std::setw(12) << speedup / ratio << "\n";
+        }
+    }
+}
+
+// OMP_PROC_BIND and OMP_PLACES are read once, when the OpenMP runtime is loaded, so
+// they are exported here and the process restarts itself with the same arguments
+bool applyAffinity(const BenchOptions& options, char* argv[])
+{
+    if((options.bind.empty() && options.places.empty()) || std::getenv("SORTBENCH_AFFINITY_APPLIED") != nullptr)
+    {
+        return true;
+    }
+    if(!options.bind.empty())
+    {
+        setenv("OMP_PROC_BIND", options.bind.c_str(), 1);
+    }
+    if(!options.places.empty())
+    {
+        setenv("OMP_PLACES", options.places.c_str(), 1);
+    }
+    setenv("SORTBENCH_AFFINITY_APPLIED", "1", 1);
+    execv("/proc/self/exe", argv);
+    std::cerr << "Cannot restart with the affinity settings: " << std::strerror(errno) << "\n";
+    return false;
+}
+
+// 1, 2, 4, ... up to the number of processors, which is included even if it is not a power of two
+std::vector<int> defaultThreadCounts()
+{
+    std::vector<int> counts;
+    int procs = omp_get_num_procs();
+    for(int t = 1; t < procs; t *= 2)
+    {
+        counts.push_back(t);
+    }
+    counts.push_back(procs);
+    return counts;
+}
+
+// Runs the warmups and timed repetitions of one engine on input[0..size); false if a run failed verification
+bool measureEngine(const SortEngine* engine, const BenchOptions& options, const std::vector<int>& input, std::vector<int>& work,
+                   int size, const char* series, int threads, PerfCounters& counters, std::vector<BenchResult>& results)
+{
+    unsigned long long checksum = permutationChecksum(input.data(), size);
+    std::cerr << engine->name << " with " << size << " " << distributionName(options.input.distribution) << " elements";
+    if(std::string(series) != "fixed")
+    {
+        std::cerr << " on " << threads << " threads";
+    }
+    std::cerr << "...\n";
+
+    for(int w = 0; w < options.warmup; w++)
+    {
+        std::copy(input.begin(), input.begin() + size, work.begin());
+        engine->run(work.data(), size);
+    }
+    for(int rep = 0; rep < options.reps; rep++)
+    {
+        std::copy(input.begin(), input.begin() + size, work.begin());
+        resetPhaseTimers();
+        phaseTimingEnabled = options.phases;
+        counters.start();
+        auto start = std::chrono::steady_clock::now();
+        engine->run(work.data(), size);
+        auto end = std::chrono::steady_clock::now();
+        counters.stop();
+        phaseTimingEnabled = false;
+
+        if(!isSorted(work.data(), size) || permutationChecksum(work.data(), size) != checksum)
+        {
+            std::cerr << engine->name << " FAILED verification with " << size << " elements, its times are dropped\n";
+            return false;
+        }
+        BenchResult result{engine, options.input.distribution, series, engine->parallel ? threads : 1, size, rep,
+                           std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count(), {}, counters.read()};
+        for(int p = 0; p < PHASE_COUNT; p++)
+        {
+            result.phaseNs[p] = phaseTotalNs(static_cast<SortPhase>(p));
+        }
+        results.push_back(result);
+    }
+    return true;
+}
+
+// Times the engine of every selected tunable with each candidate value, keeps the fastest
+// in the tuning cache and writes the cache file; false if an engine failed verification
+bool runAutotune(const BenchOptions& options, const std::vector<const SortEngine*>& engines, std::vector<int>& work,
+                 PerfCounters& counters, std::ostream& out)
+{
+    std::vector<int> threadCounts = options.threads;
+    if(threadCounts.empty())
+    {
+        threadCounts.push_back(omp_get_max_threads());
+    }
+    std::vector<std::vector<int>> inputs;
+    for(int size : options.sizes)
+    {
+        inputs.emplace_back(size);
+        fillDistribution(inputs.back().data(), size, options.input);
+    }
+
+    out << std::left << std::setw(24) << "tunable" << std::setw(24) << "engine" << std::right << std::setw(8) << "threads"
+        << std::setw(10) << "default" << std::setw(10) << "best" << std::setw(14) << "default ms" << std::setw(14) << "best ms" << "\n";
+    for(Tunable& tunable : tunableRegistry())
+    {
+        const SortEngine* engine = findSortEngine(tunable.engine);
+        if(engine == nullptr || std::find(engines.begin(), engines.end(), engine) == engines.end())
+        {
+            continue;
+        }
+        std::vector<int> candidates;
+        for(int value = tunable.minValue; value <= tunable.maxValue; value *= 2)
+        {
+            candidates.push_back(value);
+        }
+        if(std::find(candidates.begin(), candidates.end(), tunable.defaultValue) == candidates.end())
+        {
+            candidates.push_back(tunable.defaultValue);
+            std::sort(candidates.begin(), candidates.end());
+        }
+
+        for(int threads : engine->parallel ? threadCounts : std::vector<int>{1})
+        {
+            omp_set_num_threads(threads);
+            // The other tunables run with their values for this team size
+            applyTuning(threads);
+
+            int best = tunable.defaultValue;
+            double bestTime = 0, defaultTime = 0;
+            for(int candidate : candidates)
+            {
+                std::cerr << tunable.name << " = " << candidate << " on " << threads << " threads\n";
+                *tunable.value = candidate;
+                double total = 0;
+                for(size_t i = 0; i < inputs.size(); i++)
+                {
+                    std::vector<BenchResult> runs;
+                    if(!measureEngine(engine, options, inputs[i], work, options.sizes[i], "fixed", threads, counters, runs))
+                    {
+                        applyTuning(tunable, threads);
+                        return false;
+                    }
+                    std::vector<long long> times;
+                    for(const BenchResult& r : runs)
+                    {
+                        times.push_back(r.timeNs);
+                    }
+                    std::sort(times.begin(), times.end());
+                    total += times[times.size() / 2];
+                }
+                if(candidate == tunable.defaultValue)
+                {
+                    defaultTime = total;
+                }
+                if(bestTime == 0 || total < bestTime)
+                {
+                    best = candidate;
+                    bestTime = total;
+                }
+            }
+
+            std::vector<TuningEntry>& cache = tuningCache();
+            auto entry = std::find_if(cache.begin(), cache.end(), [&](const TuningEntry& e) {
+                return e.name == tunable.name && e.threads == threads && e.type == TUNING_ELEMENT_TYPE;
+            });
+            if(entry != cache.end())
+            {
+                entry->value = best;
+            }
+            else
+            {
+                cache.push_back(TuningEntry{tunable.name, threads, TUNING_ELEMENT_TYPE, best});
+            }
+            *tunable.value = best;
+
+            out << std::left << std::setw(24) << tunable.name << std::setw(24) << tunable.engine << std::right << std::setw(8) << threads
+                << std::setw(10) << tunable.defaultValue << std::setw(10) << best << std::fixed << std::setprecision(3)
+                << std::setw(14) << defaultTime / 1e6 << std::setw(14) << bestTime / 1e6 << "\n";
+        }
+    }
+
+    if(!writeTuningCache(options.tuningCache, tuningCache()))
+    {
+        std::cerr << "Cannot write " << options.tuningCache << "\n";
+        return false;
+    }
+    std::cerr << "Tuning cache written to " << options.tuningCache << "\n";
+    return true;
+}
+
+struct BenchPass
+{
+    const char* series;
+    int threads;
+};
+
+int main(int argc, char* argv[])
+{
+    BenchOptions options;
+    options.input.seed = 42;
+    if(!parseOptions(argc, argv, options))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if(!applyAffinity(options, argv))
+    {
+        return 1;
+    }
+
+    if(options.list)
+    {
+        for(const SortEngine& engine : sortRegistry())
+        {
+            std::cout << engine.name << " (" << engine.family << ", " << (engine.parallel ? "parallel" : "serial") << ")\n";
+        }
+        return 0;
+    }
+
+    std::vector<const SortEngine*> engines;
+    if(options.engines.empty())
+    {
+        for(const SortEngine& engine : sortRegistry())
+        {
+            engines.push_back(&engine);
+        }
+    }
+    for(const std::string& name : options.engines)
+    {
+        const SortEngine* engine = findSortEngine(name);
+        if(engine == nullptr)
+        {
+            std::cerr << "Unknown engine " << name << " (see --list)\n";
+            return 1;
+        }
+        engines.push_back(engine);
+    }
+
+    if(options.autotune)
+    {
+        int maxSize = *std::max_element(options.sizes.begin(), options.sizes.end());
+        std::vector<int> work(maxSize);
+        std::fill(work.begin(), work.end(), 0);
+        PerfCounters counters;
+        return runAutotune(options, engines, work, counters, std::cout) ? 0 : 1;
+    }
+
+    // The default run is a single pass with the default team; scaling runs one pass per thread count
+    std::vector<BenchPass> passes;
+    bool scaling = !options.scaling.empty();
+    if(scaling)
+    {
+        if(options.threads.empty())
+        {
+            options.threads = defaultThreadCounts();
+        }
+        std::sort(options.threads.begin(), options.threads.end());
+        for(const char* series : {"strong", "weak"})
+        {
+            if(options.scaling == series || options.scaling == "both")
+            {
+                for(int threads : options.threads)
+                {
+                    passes.push_back(BenchPass{series, threads});
+                }
+            }
+        }
+        // Serial engines have nothing to scale
+        engines.erase(std::remove_if(engines.begin(), engines.end(), [](const SortEngine* e) { return !e->parallel; }), engines.end());
+        if(engines.empty())
+        {
+            std::cerr << "--scaling needs at least one parallel engine\n";
+            return 1;
+        }
+        std::cerr << "OMP_PROC_BIND=" << (std::getenv("OMP_PROC_BIND") ? std::getenv("OMP_PROC_BIND") : "(unset)")
+                  << " OMP_PLACES=" << (std::getenv("OMP_PLACES") ? std::getenv("OMP_PLACES") : "(unset)")
+                  << ", " << omp_get_num_procs() << " processors\n";
+    }
+    else
+    {
+        passes.push_back(BenchPass{"fixed", omp_get_max_threads()});
+    }
+
+    int maxThreads = 1;
+    for(const BenchPass& pass : passes)
+    {
+        maxThreads = std::max(maxThreads, pass.threads);
+    }
+    int maxSize = *std::max_element(options.sizes.begin(), options.sizes.end());
+    if(options.scaling == "weak" || options.scaling == "both")
+    {
+        maxSize *= maxThreads;
+    }
+    std::vector<int> input(maxSize);
+    std::vector<int> work(maxSize);
+    // Touch the buffers and start the largest OpenMP team before anything is timed
+    std::fill(input.begin(), input.end(), 0);
+    std::fill(work.begin(), work.end(), 0);
+    omp_set_num_threads(maxThreads);
+    #pragma omp parallel
+    {
+        #pragma omp single
+        maxThreads = omp_get_num_threads();
+    }
+
+    // Opened on the largest team, so the counters cover every thread any pass uses
+    PerfCounters counters;
+    if(options.perf && !counters.open())
+    {
+        std::cerr << counters.error() << ", reporting timings only\n";
+    }
+
+    std::vector<BenchResult> results;
+    std::vector<const SortEngine*> failed;
+    for(const BenchPass& pass : passes)
+    {
+        omp_set_num_threads(pass.threads);
+        applyTuning(pass.threads);
+        bool weak = std::string(pass.series) == "weak";
+        for(int baseSize : options.sizes)
+        {
+            int size = weak ? baseSize * pass.threads : baseSize;
+            // Shapes like organpipe or sawtooth depend on the size, so every size gets its own input
+            fillDistribution(input.data(), size, options.input);
+            for(const SortEngine* engine : engines)
+            {
+                if(std::find(failed.begin(), failed.end(), engine) != failed.end())
+                {
+                    continue;
+                }
+                if(!measureEngine(engine, options, input, work, size, pass.series, pass.threads, counters, results))
+                {
+                    failed.push_back(engine);
+                }
+            }
+        }
+    }
+
+    std::ofstream file;
+    if(!options.output.empty())
+    {
+        file.open(options.output);
+        if(!file)
+        {
+            std::cerr << "Cannot open " << options.output << "\n";
+            return 1;
+        }
+    }
+    std::ostream& out = options.output.empty() ? std::cout : file;
+    if(options.format == "csv")
+    {
+        writeCsv(out, results);
+    }
+    else if(options.format == "json")
+    {
+        writeJson(out, results);
+    }
+    else if(scaling)
+    {
+        writeScalingTable(out, results);
+    }
+    else
+    {
+        writeTable(out, results);
+    }
+    return failed.empty() ? 0 : 1;
+}
@@ -0,0 +1,112 @@
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <omp.h>
+
+#include "quickSort.h"
+#include "mergeSort.h"
+#include "bitonicSort.h"
+#include "workStealing.h"
+#include "benchHarness.h"
+
+/* OpenMP tasks against the work-stealing pool (workStealing.h).
+
+Usage: taskOverhead <array_size> <cutoff,...> [options]
+
+First it times a binary tree of 2^20 empty fork-joins on both backends, which is the
+bare cost of a task: creating it, handing it to another thread or taking it back, and
+waiting for it. Then, for every task cutoff of the list, it sets the cutoffs of
+quickSortParallel, mergeSortParallelHelper and bitonicSortParallelHelper to that value
+and times the three sorts on both backends. Small cutoffs create many small tasks,
+which is where the two schedulers differ the most. Scaling over thread counts is
+measured by sortbench with the *Stealing engines, e.g.
+`sortbench --engines mergeSortParallel,mergeSortParallelStealing --threads 1,2,4,8`. */
+
+const int FORK_TREE_DEPTH = 20;
+
+inline long long forkTree(int depth)
+{
+    if (depth == 0) {
+        return 1;
+    }
+    long long left = 0, right = 0;
+    forkJoin([&] { left = forkTree(depth - 1); }, [&] { right = forkTree(depth - 1); });
+    return left + right;
+}
+
+// Best of three runs of the fork tree, after one warm-up
+void timeForkTree(const std::string& label, TaskBackend backend) {
+    long long best = -1;
+    long long leaves = 0;
+    for (int rep = 0; rep < 4; rep++) {
+        auto start = std::chrono::steady_clock::now();
+        runTaskRoot(backend, [&] { leaves = forkTree(FORK_TREE_DEPTH); });
+        auto end = std::chrono::steady_clock::now();
+        long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        if (rep > 0 && (best < 0 || ns < best)) {
+            best = ns;
+        }
+    }
+    long long forks = leaves - 1;
+    std::cout << label << " time: " << best << " ns (" << (double)best / forks << " ns per fork, "
+              << forks << " forks)\n";
+}
+
+int main(int argc, char* argv[]) {
+    BenchArgs args;
+    if (argc < 3 || !parseBenchArgs(argc, argv, 3, args)) {
+        std::cerr << "Usage: " << argv[0] << " <array_size> <cutoff,...> " << DISTRIBUTION_USAGE
+                  << " [--phases] [--perf] " << MAPPED_FILE_USAGE << "\n"
+                  << "cutoff: comma-separated task cutoffs, e.g. 256,1024,4096,16384\n";
+        return 1;
+    }
+
+    int n = std::atoi(argv[1]);
+
+    std::vector<int> cutoffs;
+    std::stringstream list(argv[2]);
+    std::string item;
+    while (std::getline(list, item, ',')) {
+        int cutoff = std::atoi(item.c_str());
+        if (cutoff < 1) {
+            std::cerr << "Invalid cutoff " << item << "\n";
+            return 1;
+        }
+        cutoffs.push_back(cutoff);
+    }
+
+    BenchData<int> data(args, n);
+    if (!data.valid()) {
+        return 1;
+    }
+    n = data.size();
+    int* arr = data.arr;
+
+    std::cout << "Threads: " << omp_get_max_threads() << "\n";
+    timeForkTree("Fork Tree OpenMP", TaskBackend::OpenMP);
+    timeForkTree("Fork Tree Work Stealing", TaskBackend::WorkStealing);
+
+    BenchReport report(args, data);
+    for (int cutoff : cutoffs) {
+        std::string suffix = " (cutoff " + std::to_string(cutoff) + ")";
+        quickSortTaskCutoff = cutoff;
+        mergeSortTaskCutoff = cutoff;
+        bitonicSortTaskCutoff = cutoff;
+        report.run("Quick Sort Parallel OpenMP" + suffix, arr, [&] { quickSortParallelEntry(arr, 0, n - 1); });
+        report.run("Quick Sort Parallel Work Stealing" + suffix, arr,
+                   [&] { quickSortParallelEntry(arr, 0, n - 1, TaskBackend::WorkStealing); });
+        report.run("Merge Sort Parallel OpenMP" + suffix, arr, [&] { mergeSortParallel(arr, 0, n - 1); });
+        report.run("Merge Sort Parallel Work Stealing" + suffix, arr,
+                   [&] { mergeSortParallel(arr, 0, n - 1, TaskBackend::WorkStealing); });
+        report.run("Bitonic Sort Parallel OpenMP" + suffix, arr, [&] { bitonicSortParallelPadded(arr, n); });
+        report.run("Bitonic Sort Parallel Work Stealing" + suffix, arr,
+                   [&] { bitonicSortParallelPadded(arr, n, TaskBackend::WorkStealing); });
+    }
+    report.print();
+
+    return report.allVerified() ? 0 : 1;
+}
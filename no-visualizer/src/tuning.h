@@ -0,0 +1,163 @@
+#ifndef TUNING_H
+#define TUNING_H
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <omp.h>
+
+/* Tunable granularity parameters and the tuning cache.
+
+The task cutoffs of the parallel engines and the insertion sort size of intro sort
+are plain int variables registered with REGISTER_TUNABLE, next to the engine that
+uses them. The hot code reads them like the constants they replace. Their best value
+depends on the machine and on the number of threads, so `sortbench --autotune`
+measures them and writes the winners to a small text cache, one line per parameter,
+thread count and element type:
+
+    # parameter threads type value
+    mergeSortTaskCutoff 8 int 16384
+
+When a tunable is registered at program startup it takes the cache entry for the
+default team size: the entry with that exact thread count, otherwise the one with the
+closest smaller count (or the smallest count if all are larger). Without an entry it
+keeps its built-in default. applyTuning(threads) re-selects every tunable for a
+different team size. The cache is tuningCache.txt in the working directory, or the
+file named by the SORT_TUNING_CACHE environment variable. */
+struct Tunable
+{
+    std::string name;
+    std::string engine;  // sortbench engine whose time the parameter is tuned for
+    int* value;
+    int defaultValue;
+    int minValue;  // the autotuner tries minValue, 2 * minValue, ... up to maxValue
+    int maxValue;
+};
+
+struct TuningEntry
+{
+    std::string name;
+    int threads;
+    std::string type;
+    int value;
+};
+
+// Every engine sorts ints for now; the type column keeps the cache open for other key types
+const char* const TUNING_ELEMENT_TYPE = "int";
+
+inline std::vector<Tunable>& tunableRegistry()
+{
+    static std::vector<Tunable> tunables;
+    return tunables;
+}
+
+inline std::string tuningCachePath()
+{
+    const char* path = std::getenv("SORT_TUNING_CACHE");
+    return path != nullptr ? path : "tuningCache.txt";
+}
+
+inline std::vector<TuningEntry> readTuningCache(const std::string& path)
+{
+    std::vector<TuningEntry> entries;
+    std::ifstream file(path);
+    std::string line;
+    while(std::getline(file, line))
+    {
+        if(line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        std::istringstream fields(line);
+        TuningEntry entry;
+        if(fields >> entry.name >> entry.threads >> entry.type >> entry.value)
+        {
+            entries.push_back(entry);
+        }
+    }
+    return entries;
+}
+
+inline bool writeTuningCache(const std::string& path, const std::vector<TuningEntry>& entries)
+{
+    std::ofstream file(path);
+    if(!file)
+    {
+        return false;
+    }
+    file << "# parameter threads type value (written by sortbench --autotune)\n";
+    for(const TuningEntry& entry : entries)
+    {
+        file << entry.name << " " << entry.threads << " " << entry.type << " " << entry.value << "\n";
+    }
+    return (bool)file;
+}
+
+// The cache as read at startup; sortbench --autotune updates it in place
+inline std::vector<TuningEntry>& tuningCache()
+{
+    static std::vector<TuningEntry> cache = readTuningCache(tuningCachePath());
+    return cache;
+}
+
+inline const TuningEntry* findTuning(const std::string& name, int threads)
+{
+    const TuningEntry* best = nullptr;
+    for(const TuningEntry& entry : tuningCache())
+    {
+        if(entry.name != name || entry.type != TUNING_ELEMENT_TYPE)
+        {
+            continue;
+        }
+        bool better;
+        if(best == nullptr)
+        {
+            better = true;
+        }
+        else if(best->threads > threads)
+        {
+            // Nothing at or below threads yet: prefer anything closer from below, else the smaller count
+            better = entry.threads <= threads || entry.threads < best->threads;
+        }
+        else
+        {
+            better = entry.threads <= threads && entry.threads > best->threads;
+        }
+        if(better)
+        {
+            best = &entry;
+        }
+    }
+    return best;
+}
+
+inline void applyTuning(Tunable& tunable, int threads)
+{
+    const TuningEntry* entry = findTuning(tunable.name, threads);
+    *tunable.value = entry != nullptr ? entry->value : tunable.defaultValue;
+}
+
+// Selects the tuned value of every tunable for a team of the given size
+inline void applyTuning(int threads)
+{
+    for(Tunable& tunable : tunableRegistry())
+    {
+        applyTuning(tunable, threads);
+    }
+}
+
+struct TunableRegistrar
+{
+    TunableRegistrar(const char* name, const char* engine, int* value, int minValue, int maxValue)
+    {
+        tunableRegistry().push_back(Tunable{name, engine, value, *value, minValue, maxValue});
+        applyTuning(tunableRegistry().back(), omp_get_max_threads());
+    }
+};
+
+#define REGISTER_TUNABLE(variable, engine, minValue, maxValue) \
+    static TunableRegistrar tunableRegistrar_##variable(#variable, engine, &variable, minValue, maxValue);
+
+#endif
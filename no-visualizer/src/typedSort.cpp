@@ -0,0 +1,83 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include <chrono>
+#include <algorithm>
+#include <string>
+#include <omp.h>
+
+#include "sortLibrary.h"
+#include "benchHarness.h"
+
+/* Benchmark of the generic engines of sortLibrary.h on other key types.
+
+Usage: typedSort <array_size> <int|int64|uint32|float|double> <quick|merge|bitonic|heap|selection|bubble> [options]
+
+Prints the serial and the parallel time of the chosen algorithm, like the other
+benchmark binaries, on keys of the chosen type generated from the same distributions, or read from an --input
+file of keys of that type. */
+
+const char* const ALGORITHMS[] = {"quick", "merge", "bitonic", "heap", "selection", "bubble"};
+
+template<typename T>
+int runTyped(const std::string& algorithm, int n, const BenchArgs& args) {
+    BenchData<T> data(args, n);
+    if (!data.valid()) {
+        return 1;
+    }
+    n = data.size();
+    T* arr = data.arr;
+
+    BenchReport report(args, data);
+    auto time = [&](const std::string& label, auto serial, auto parallel) {
+        report.run(label, arr, [&] { serial(arr, arr + n); });
+        report.run(label + " Parallel", arr, [&] { parallel(arr, arr + n); });
+    };
+    if (algorithm == "quick")
+        time("Quick Sort", [](T* f, T* l) { sortlib::quickSort(f, l); }, [](T* f, T* l) { sortlib::quickSortParallel(f, l); });
+    else if (algorithm == "merge")
+        time("Merge Sort", [](T* f, T* l) { sortlib::mergeSort(f, l); }, [](T* f, T* l) { sortlib::mergeSortParallel(f, l); });
+    else if (algorithm == "bitonic")
+        time("Bitonic Sort", [](T* f, T* l) { sortlib::bitonicSort(f, l); }, [](T* f, T* l) { sortlib::bitonicSortParallel(f, l); });
+    else if (algorithm == "heap")
+        time("Heap Sort", [](T* f, T* l) { sortlib::heapSort(f, l); }, [](T* f, T* l) { sortlib::heapSortParallel(f, l); });
+    else if (algorithm == "selection")
+        time("Selection Sort", [](T* f, T* l) { sortlib::selectionSort(f, l); }, [](T* f, T* l) { sortlib::selectionSortParallel(f, l); });
+    else
+        time("Bubble Sort", [](T* f, T* l) { sortlib::bubbleSort(f, l); }, [](T* f, T* l) { sortlib::bubbleSortParallel(f, l); });
+    report.print();
+
+    return report.allVerified() ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    BenchArgs args;
+    if (argc < 4 || !parseBenchArgs(argc, argv, 4, args)) {
+        std::cerr << "Usage: " << argv[0] << " <array_size> <int|int64|uint32|float|double>"
+                  << " <quick|merge|bitonic|heap|selection|bubble> " << DISTRIBUTION_USAGE << " [--phases] [--perf] " << MAPPED_FILE_USAGE << "\n";
+        return 1;
+    }
+
+    int n = std::atoi(argv[1]);
+    std::string type = argv[2];
+    std::string algorithm = argv[3];
+
+    if (std::find(std::begin(ALGORITHMS), std::end(ALGORITHMS), algorithm) == std::end(ALGORITHMS)) {
+        std::cerr << "Unknown algorithm " << algorithm << "\n";
+        return 1;
+    }
+
+    if (type == "int")
+        return runTyped<int>(algorithm, n, args);
+    if (type == "int64")
+        return runTyped<int64_t>(algorithm, n, args);
+    if (type == "uint32")
+        return runTyped<uint32_t>(algorithm, n, args);
+    if (type == "float")
+        return runTyped<float>(algorithm, n, args);
+    if (type == "double")
+        return runTyped<double>(algorithm, n, args);
+
+    std::cerr << "Unknown key type " << type << ", expected int, int64, uint32, float or double\n";
+    return 1;
+}
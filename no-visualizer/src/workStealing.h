@@ -0,0 +1,468 @@
+#ifndef WORK_STEALING_H
+#define WORK_STEALING_H
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <omp.h>
+
+#include "perfCounters.h"
+#include "phaseTimer.h"
+
+/* A work-stealing task pool, as an alternative to OpenMP tasks.
+
+The recursive parallel sorts (quickSortParallel, introSortParallelRec,
+mergeSortParallelHelper and bitonicSortParallelHelper) fork with forkJoin() and split their partitions and merges
+with forEachTask(). Inside a parallel region these are `#pragma omp task` and
+`taskwait`, so the cost of a task and the order in which idle threads pick them up is
+whatever the OpenMP runtime does. Run from the WorkStealingPool, they use the pool
+below instead:
+
+- every worker owns a Chase-Lev deque (the C11 version of Le, Pop, Cohen and Zappa
+  Nardelli). The owner pushes and pops tasks at the bottom without any atomic
+  read-modify-write unless it races for the last task; idle workers steal from the
+  top of a randomly chosen victim's deque with one compare-and-swap. The deque grows
+  by doubling; the old arrays stay allocated until the pool is destroyed, because a
+  thief may still be reading them;
+- tasks are not allocated: a SpawnedTask lives in the stack frame that spawns it,
+  which cannot return before sync() has seen the task finish;
+- the join is a helping join. forkJoin spawns the left half and runs the right half
+  itself, like the work-first policy of Cilk; if the left half was not stolen the
+  sync pops it back and runs it inline, so an unstolen fork costs a push and a pop.
+  While a stolen child is still running the waiting worker executes other tasks,
+  its own first and then stolen ones, instead of blocking. True continuation
+  stealing needs compiler support, this is the usual library approximation of it;
+- the thread that calls run() becomes worker 0 for the duration of the root task.
+  The other workers spin on steal attempts (yielding after every failed round)
+  while a root task runs, and sleep on a condition variable between runs.
+
+workStealingPool() keeps one pool and recreates it when the requested number of
+workers changes, so every engine run uses omp_get_max_threads() workers like the
+OpenMP version. Pool workers are not OpenMP threads: the phase timers use their worker
+index (phaseThreadSlot), and since --perf only follows the OpenMP team, every run()
+marks the counters of the current measurement as unavailable (perfUncountedRuns). */
+enum class TaskBackend
+{
+    OpenMP,
+    WorkStealing
+};
+
+struct PoolTask
+{
+    void (*execute)(PoolTask* task);
+    std::atomic<int>* pending;  // the spawning group's counter, decremented once the task has run
+};
+
+template<typename F>
+class SpawnedTask : public PoolTask
+{
+public:
+    explicit SpawnedTask(F& body) : body(&body)
+    {
+        execute = &SpawnedTask::run;
+        pending = nullptr;
+    }
+
+private:
+    static void run(PoolTask* task)
+    {
+        (*static_cast<SpawnedTask*>(task)->body)();
+    }
+
+    F* body;
+};
+
+class ChaseLevDeque
+{
+public:
+    ChaseLevDeque() : top(0), bottom(0), ring(new Ring(64))
+    {
+        rings.emplace_back(ring.load(std::memory_order_relaxed));
+    }
+
+    // Owner only
+    void push(PoolTask* task)
+    {
+        long long b = bottom.load(std::memory_order_relaxed);
+        long long t = top.load(std::memory_order_acquire);
+        Ring* r = ring.load(std::memory_order_relaxed);
+        if(b - t > r->capacity - 1)
+        {
+            r = grow(r, t, b);
+        }
+        r->put(b, task);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    // Owner only; null if the deque is empty or a thief took the last task
+    PoolTask* pop()
+    {
+        long long b = bottom.load(std::memory_order_relaxed) - 1;
+        Ring* r = ring.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        long long t = top.load(std::memory_order_relaxed);
+        if(t > b)
+        {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        PoolTask* task = r->get(b);
+        if(t == b)
+        {
+            if(!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                task = nullptr;
+            }
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return task;
+    }
+
+    // Any thread; null if the deque is empty or another thief or the owner won the race
+    PoolTask* steal()
+    {
+        long long t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        long long b = bottom.load(std::memory_order_acquire);
+        if(t >= b)
+        {
+            return nullptr;
+        }
+        PoolTask* task = ring.load(std::memory_order_acquire)->get(t);
+        if(!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            return nullptr;
+        }
+        return task;
+    }
+
+private:
+    struct Ring
+    {
+        explicit Ring(long long capacity) : capacity(capacity), slots(new std::atomic<PoolTask*>[capacity]) {}
+
+        PoolTask* get(long long i) const
+        {
+            return slots[i & (capacity - 1)].load(std::memory_order_relaxed);
+        }
+
+        void put(long long i, PoolTask* task)
+        {
+            slots[i & (capacity - 1)].store(task, std::memory_order_relaxed);
+        }
+
+        long long capacity;
+        std::unique_ptr<std::atomic<PoolTask*>[]> slots;
+    };
+
+    Ring* grow(Ring* old, long long t, long long b)
+    {
+        Ring* bigger = new Ring(old->capacity * 2);
+        for(long long i = t; i < b; i++)
+        {
+            bigger->put(i, old->get(i));
+        }
+        rings.emplace_back(bigger);
+        ring.store(bigger, std::memory_order_release);
+        return bigger;
+    }
+
+    alignas(64) std::atomic<long long> top;
+    alignas(64) std::atomic<long long> bottom;
+    std::atomic<Ring*> ring;
+    std::vector<std::unique_ptr<Ring>> rings;  // every ring ever used, freed with the deque
+};
+
+class WorkStealingPool;
+
+inline thread_local WorkStealingPool* currentPool = nullptr;
+inline thread_local int currentWorker = -1;
+
+class WorkStealingPool
+{
+public:
+    explicit WorkStealingPool(int workers) : deques(workers), running(false), stopping(false)
+    {
+        for(auto& deque : deques)
+        {
+            deque.reset(new ChaseLevDeque());
+        }
+        for(int w = 1; w < workers; w++)
+        {
+            threads.emplace_back([this, w] { workerLoop(w); });
+        }
+    }
+
+    ~WorkStealingPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for(std::thread& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    int size() const
+    {
+        return (int)deques.size();
+    }
+
+    // The pool of the calling thread, or null outside of a pool task
+    static WorkStealingPool* current()
+    {
+        return currentPool;
+    }
+
+    // Runs root on the calling thread as worker 0, with the other workers stealing the tasks it spawns
+    template<typename F>
+    void run(F&& root)
+    {
+        WorkStealingPool* outerPool = currentPool;
+        int outerWorker = currentWorker;
+        int outerSlot = phaseThreadSlot;
+        perfUncountedRuns.fetch_add(1, std::memory_order_relaxed);
+        currentPool = this;
+        currentWorker = 0;
+        phaseThreadSlot = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running.store(true, std::memory_order_relaxed);
+        }
+        wake.notify_all();
+
+        root();
+
+        running.store(false, std::memory_order_relaxed);
+        currentPool = outerPool;
+        currentWorker = outerWorker;
+        phaseThreadSlot = outerSlot;
+    }
+
+    // Pushes a task on the calling worker's deque
+    void spawn(PoolTask* task)
+    {
+        deques[currentWorker]->push(task);
+    }
+
+    // Helping join: runs other tasks until pending drops to zero
+    void waitFor(const std::atomic<int>& pending)
+    {
+        unsigned seed = 2654435761u * (unsigned)(currentWorker + 1);
+        while(pending.load(std::memory_order_acquire) > 0)
+        {
+            PoolTask* task = deques[currentWorker]->pop();
+            if(task == nullptr)
+            {
+                task = stealOnce(seed);
+            }
+            if(task != nullptr)
+            {
+                execute(task);
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    static void execute(PoolTask* task)
+    {
+        // The task lives in its parent's frame, which may be gone as soon as the counter drops
+        std::atomic<int>* pending = task->pending;
+        task->execute(task);
+        pending->fetch_sub(1, std::memory_order_release);
+    }
+
+    // One round over the other workers, starting at a random victim
+    PoolTask* stealOnce(unsigned& seed)
+    {
+        int workers = size();
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        int first = (int)(seed % (unsigned)workers);
+        for(int i = 0; i < workers; i++)
+        {
+            int victim = (first + i) % workers;
+            if(victim == currentWorker)
+            {
+                continue;
+            }
+            if(PoolTask* task = deques[victim]->steal())
+            {
+                return task;
+            }
+        }
+        return nullptr;
+    }
+
+    void workerLoop(int worker)
+    {
+        currentPool = this;
+        currentWorker = worker;
+        phaseThreadSlot = worker;
+        unsigned seed = 2654435761u * (unsigned)(worker + 1);
+        while(true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || running.load(std::memory_order_relaxed); });
+                if(stopping)
+                {
+                    return;
+                }
+            }
+            while(running.load(std::memory_order_relaxed))
+            {
+                PoolTask* task = deques[worker]->pop();
+                if(task == nullptr)
+                {
+                    task = stealOnce(seed);
+                }
+                if(task != nullptr)
+                {
+                    execute(task);
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<ChaseLevDeque>> deques;
+    std::vector<std::thread> threads;
+    std::atomic<bool> running;  // a root task is executing
+    bool stopping;
+    std::mutex mutex;
+    std::condition_variable wake;
+};
+
+// The shared pool, recreated when the number of workers changes
+inline WorkStealingPool& workStealingPool(int workers)
+{
+    static std::unique_ptr<WorkStealingPool> pool;
+    if(!pool || pool->size() != workers)
+    {
+        pool.reset();
+        pool.reset(new WorkStealingPool(workers));
+    }
+    return *pool;
+}
+
+// Pending pool tasks of one spawn/sync scope
+class TaskGroup
+{
+public:
+    TaskGroup() : pending(0) {}
+
+    // The task must stay alive until sync() returns
+    void spawn(PoolTask& task)
+    {
+        task.pending = &pending;
+        pending.fetch_add(1, std::memory_order_relaxed);
+        WorkStealingPool::current()->spawn(&task);
+    }
+
+    void sync()
+    {
+        WorkStealingPool::current()->waitFor(pending);
+    }
+
+private:
+    std::atomic<int> pending;
+};
+
+// Runs root on the given backend: in an OpenMP parallel region (by a single thread) or in the pool
+template<typename F>
+inline void runTaskRoot(TaskBackend backend, F&& root)
+{
+    if(backend == TaskBackend::WorkStealing)
+    {
+        workStealingPool(omp_get_max_threads()).run(root);
+        return;
+    }
+    #pragma omp parallel
+    {
+        #pragma omp single
+        {
+            root();
+        }
+    }
+}
+
+// Number of threads the current backend can run tasks on
+inline int taskTeamSize()
+{
+    WorkStealingPool* pool = WorkStealingPool::current();
+    return pool != nullptr ? pool->size() : omp_get_num_threads();
+}
+
+// Runs left and right as two parallel tasks and waits for both
+template<typename F, typename G>
+inline void forkJoin(F&& left, G&& right)
+{
+    if(WorkStealingPool::current() != nullptr)
+    {
+        TaskGroup group;
+        SpawnedTask<typename std::remove_reference<F>::type> task(left);
+        group.spawn(task);
+        right();
+        group.sync();
+        return;
+    }
+    #pragma omp task shared(left)
+    left();
+    #pragma omp task shared(right)
+    right();
+    #pragma omp taskwait
+}
+
+// Runs body(0), ..., body(count - 1) as parallel tasks and waits for all of them
+template<typename F>
+inline void forEachTask(int count, F&& body)
+{
+    if(WorkStealingPool::current() != nullptr)
+    {
+        auto call = [&body](int i) { return [&body, i] { body(i); }; };
+        typedef decltype(call(0)) Call;
+        std::vector<Call> calls;
+        calls.reserve(count);
+        std::vector<SpawnedTask<Call>> tasks;
+        tasks.reserve(count);
+        TaskGroup group;
+        for(int i = 1; i < count; i++)
+        {
+            calls.push_back(call(i));
+            tasks.emplace_back(calls.back());
+            group.spawn(tasks.back());
+        }
+        if(count > 0)
+        {
+            body(0);
+        }
+        group.sync();
+        return;
+    }
+    for(int i = 0; i < count; i++)
+    {
+        #pragma omp task firstprivate(i) shared(body)
+        body(i);
+    }
+    #pragma omp taskwait
+}
+
+#endif